@@ -0,0 +1,77 @@
+#include "bandwidth_regulator.h"
+#include <algorithm>
+
+namespace dramsim3 {
+
+BandwidthRegulator::BandwidthRegulator(const Config& config)
+    : num_sources_(config.num_sources),
+      peak_(1.0 / config.burst_cycle),
+      depth_(config.bw_bucket_depth),
+      limit_(config.num_sources),
+      reserve_(config.num_sources),
+      num_reserved_(0) {
+    for (int s = 0; s < num_sources_; s++) {
+        SetSource(s, config.source_bw_limits[s],
+                  config.source_bw_reservations[s]);
+    }
+}
+
+int BandwidthRegulator::Source(int source_id) const {
+    if (source_id < 0 || source_id >= num_sources_) {
+        return num_sources_ - 1;
+    }
+    return source_id;
+}
+
+void BandwidthRegulator::SetSource(int source_id, double limit,
+                                   double reservation) {
+    int s = Source(source_id);
+    if (reserve_[s].rate > 0.0) {
+        num_reserved_--;
+    }
+    limit_[s].rate = limit > 0.0 ? limit * peak_ : 0.0;
+    limit_[s].tokens = depth_;
+    reserve_[s].rate = reservation > 0.0 ? reservation * peak_ : 0.0;
+    reserve_[s].tokens = 0.0;
+    if (reserve_[s].rate > 0.0) {
+        num_reserved_++;
+    }
+}
+
+void BandwidthRegulator::ClockTick() {
+    for (int s = 0; s < num_sources_; s++) {
+        limit_[s].tokens = std::min(depth_, limit_[s].tokens + limit_[s].rate);
+        reserve_[s].tokens =
+            std::min(depth_, reserve_[s].tokens + reserve_[s].rate);
+    }
+}
+
+bool BandwidthRegulator::Limited(int source_id) const {
+    const auto& bucket = limit_[Source(source_id)];
+    return bucket.rate > 0.0 && bucket.tokens < 1.0;
+}
+
+bool BandwidthRegulator::Reserved(int source_id) const {
+    const auto& bucket = reserve_[Source(source_id)];
+    return bucket.rate > 0.0 && bucket.tokens >= 1.0;
+}
+
+void BandwidthRegulator::OnCAS(int source_id) {
+    int s = Source(source_id);
+    // limit tokens may go negative after a burst, the debt is paid back
+    // before the source is served again
+    if (limit_[s].rate > 0.0) {
+        limit_[s].tokens -= 1.0;
+    }
+    if (reserve_[s].rate > 0.0) {
+        reserve_[s].tokens = std::max(0.0, reserve_[s].tokens - 1.0);
+    }
+}
+
+void BandwidthRegulator::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(limit_);
+    ckpt.Field(reserve_);
+    ckpt.Field(num_reserved_);
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,43 @@
+#ifndef __BANDWIDTH_REGULATOR_H
+#define __BANDWIDTH_REGULATOR_H
+
+#include <vector>
+#include "checkpoint.h"
+#include "configuration.h"
+
+namespace dramsim3 {
+
+// Per-requestor token buckets, MPAM style memory bandwidth allocation.
+// Shares are fractions of the channel peak, one token is one CAS command.
+// A limit caps the source, a source out of limit tokens is neither admitted
+// nor served. A reservation gives the source priority at command selection
+// until its reserved share is used up.
+class BandwidthRegulator {
+   public:
+    explicit BandwidthRegulator(const Config& config);
+    // limit/reservation <= 0 means none
+    void SetSource(int source_id, double limit, double reservation);
+    void ClockTick();
+    bool Limited(int source_id) const;
+    bool Reserved(int source_id) const;
+    bool HasReservations() const { return num_reserved_ > 0; }
+    void OnCAS(int source_id);
+    void Serialize(Checkpoint& ckpt);
+
+   private:
+    struct Bucket {
+        double rate = 0.0;  // tokens per cycle, 0 if unused
+        double tokens = 0.0;
+    };
+    int Source(int source_id) const;
+
+    int num_sources_;
+    double peak_;   // CAS per cycle at full data bus utilization
+    double depth_;  // bucket capacity in tokens
+    std::vector<Bucket> limit_;
+    std::vector<Bucket> reserve_;
+    int num_reserved_;
+};
+
+}  // namespace dramsim3
+#endif
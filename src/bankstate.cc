@@ -215,4 +215,11 @@ void BankState::UpdateStateOracleForRW(const Command& cmd) {
 
 
 
+void BankState::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(state_);
+    ckpt.Field(cmd_timing_);
+    ckpt.Field(open_row_);
+    ckpt.Field(row_hit_count_);
+}
+
 }  // namespace dramsim3
@@ -2,6 +2,7 @@
 #define __BANKSTATE_H
 
 #include <vector>
+#include "checkpoint.h"
 #include "common.h"
 #include "configuration.h"
 
@@ -25,6 +26,7 @@ class BankState {
     bool IsRowOpen() const { return state_ == State::OPEN; }
     int OpenRow() const { return open_row_; }
     int RowHitCount() const { return row_hit_count_; }
+    void Serialize(Checkpoint& ckpt);
 
     // Current state of the Bank
     // Apriori or instantaneously transitions on a command.
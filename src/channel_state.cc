@@ -121,6 +121,12 @@ Command ChannelState::GetReadyCommand(const Command& cmd, uint64_t clk) const {
                 return Command();
             }
         }
+        // the bank state builds a fresh command, keep the request metadata
+        ready_cmd.source_id = cmd.source_id;
+        ready_cmd.added_cycle = cmd.added_cycle;
+        ready_cmd.qos_class = cmd.qos_class;
+        ready_cmd.deadline = cmd.deadline;
+        ready_cmd.is_prefetch = cmd.is_prefetch;
         return ready_cmd;
     }
 }
@@ -330,4 +336,19 @@ bool ChannelState::Is32AWReady(int rank, uint64_t curr_time) const {
     return true;
 }
 
+void ChannelState::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(rank_idle_cycles);
+    ckpt.Field(rank_is_sref_);
+    for (auto& rank : bank_states_) {
+        for (auto& bankgroup : rank) {
+            for (auto& bank : bankgroup) {
+                bank.Serialize(ckpt);
+            }
+        }
+    }
+    ckpt.Field(refresh_q_);
+    ckpt.Field(four_aw_);
+    ckpt.Field(thirty_two_aw_);
+}
+
 }  // namespace dramsim3
@@ -0,0 +1,153 @@
+#include "checkpoint.h"
+#include <cstring>
+#include <sstream>
+
+namespace dramsim3 {
+
+static const char CHECKPOINT_MAGIC[8] = {'D', 'R', 'A', 'M', 'C', 'K', 'P', 'T'};
+
+Checkpoint::Checkpoint(const std::string& file_name, bool restore)
+    : restore_(restore), file_name_(file_name) {
+    auto mode = std::ios::binary | (restore ? std::ios::in : std::ios::out);
+    file_.open(file_name, mode);
+    if (file_.fail()) {
+        Fail("cannot open file");
+    }
+    char magic[8];
+    std::memcpy(magic, CHECKPOINT_MAGIC, sizeof(magic));
+    uint32_t version = CHECKPOINT_VERSION;
+    Bytes(magic, sizeof(magic));
+    Field(version);
+    if (std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) {
+        Fail("not a checkpoint file");
+    }
+    if (version != CHECKPOINT_VERSION) {
+        Fail("version " + std::to_string(version) + ", expected " +
+             std::to_string(CHECKPOINT_VERSION));
+    }
+}
+
+void Checkpoint::Fail(const std::string& msg) const {
+    std::cerr << "Checkpoint " << file_name_ << ": " << msg << std::endl;
+    AbruptExit(__FILE__, __LINE__);
+}
+
+void Checkpoint::Bytes(void* data, size_t size) {
+    if (restore_) {
+        file_.read(static_cast<char*>(data), size);
+    } else {
+        file_.write(static_cast<const char*>(data), size);
+    }
+    if (file_.fail()) {
+        Fail(restore_ ? "truncated file" : "write failed");
+    }
+}
+
+uint64_t Checkpoint::Size(size_t size) {
+    uint64_t val = size;
+    Field(val);
+    return val;
+}
+
+void Checkpoint::Expect(const std::string& what, const std::string& value) {
+    std::string saved = value;
+    Field(saved);
+    if (saved != value) {
+        Fail(what + " is " + saved + ", expected " + value);
+    }
+}
+
+void Checkpoint::Field(std::string& str) {
+    str.resize(Size(str.size()));
+    if (!str.empty()) {
+        Bytes(&str[0], str.size());
+    }
+}
+
+void Checkpoint::Field(Address& addr) {
+    Field(addr.channel);
+    Field(addr.rank);
+    Field(addr.bankgroup);
+    Field(addr.bank);
+    Field(addr.row);
+    Field(addr.column);
+}
+
+void Checkpoint::Field(Command& cmd) {
+    Field(cmd.cmd_type);
+    Field(cmd.addr);
+    Field(cmd.reqd_ACT);
+    Field(cmd.induced_precharge);
+    Field(cmd.hex_addr);
+    Field(cmd.source_id);
+    Field(cmd.added_cycle);
+    Field(cmd.qos_class);
+    Field(cmd.deadline);
+    Field(cmd.is_prefetch);
+    Field(cmd.id);
+    Field(cmd.meta);
+}
+
+void Checkpoint::Field(Transaction& trans) {
+    Field(trans.addr);
+    Field(trans.added_cycle);
+    Field(trans.complete_cycle);
+    Field(trans.CRA_idx);
+    Field(trans.is_ACT);
+    Field(trans.is_write);
+    Field(trans.source_id);
+    Field(trans.qos_class);
+    Field(trans.deadline);
+    Field(trans.is_prefetch);
+    Field(trans.id);
+    Field(trans.meta);
+}
+
+void Checkpoint::Field(std::mt19937& rng) {
+    std::stringstream ss;
+    ss << rng;
+    std::string str = ss.str();
+    Field(str);
+    if (restore_) {
+        std::stringstream in(str);
+        in >> rng;
+    }
+}
+
+void Checkpoint::Field(std::mt19937_64& rng) {
+    std::stringstream ss;
+    ss << rng;
+    std::string str = ss.str();
+    Field(str);
+    if (restore_) {
+        std::stringstream in(str);
+        in >> rng;
+    }
+}
+
+void Checkpoint::Field(std::vector<bool>& vec) {
+    vec.resize(Size(vec.size()));
+    for (size_t i = 0; i < vec.size(); i++) {
+        bool val = vec[i];
+        Field(val);
+        vec[i] = val;
+    }
+}
+
+void Checkpoint::Field(std::unordered_set<int>& set) {
+    uint64_t size = Size(set.size());
+    if (!restore_) {
+        for (int val : set) {
+            Field(val);
+        }
+        return;
+    }
+    set.clear();
+    for (uint64_t i = 0; i < size; i++) {
+        int val;
+        Field(val);
+        set.insert(val);
+    }
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,160 @@
+#ifndef __CHECKPOINT_H
+#define __CHECKPOINT_H
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "common.h"
+
+namespace dramsim3 {
+
+static constexpr uint32_t CHECKPOINT_VERSION = 9;
+
+// Versioned binary file of the simulator state. Every component walks its
+// state once in Serialize(ckpt), which writes it when saving and reads it
+// back in place when restoring, so both directions share one layout.
+class Checkpoint {
+   public:
+    Checkpoint(const std::string& file_name, bool restore);
+    bool Restoring() const { return restore_; }
+
+    // saved value must match on restore, e.g. a section name or the
+    // organization of the memory system
+    void Expect(const std::string& what, const std::string& value);
+    void Section(const std::string& name) { Expect("section", name); }
+
+    // state only some configs have, saved under key (nothing if key is
+    // empty) and restored only into a component using the same key,
+    // otherwise skipped so the component keeps its fresh state
+    template <typename F>
+    bool Block(const std::string& key, F fn);
+
+    template <typename T>
+    typename std::enable_if<std::is_trivially_copyable<T>::value>::type Field(
+        T& val) {
+        Bytes(&val, sizeof(T));
+    }
+    void Field(std::string& str);
+    void Field(Address& addr);
+    void Field(Command& cmd);
+    void Field(Transaction& trans);
+    void Field(std::mt19937& rng);
+    void Field(std::mt19937_64& rng);
+    void Field(std::vector<bool>& vec);
+    void Field(std::unordered_set<int>& set);
+    template <typename T>
+    void Field(std::vector<T>& vec);
+    template <typename T>
+    void Field(std::deque<T>& deq);
+    template <typename K, typename V>
+    void Field(std::multimap<K, V>& map);
+    template <typename K, typename V>
+    void Field(std::unordered_map<K, V>& map);
+
+   private:
+    void Bytes(void* data, size_t size);
+    uint64_t Size(size_t size);
+    void Fail(const std::string& msg) const;
+
+    bool restore_;
+    std::string file_name_;
+    std::fstream file_;
+};
+
+template <typename F>
+bool Checkpoint::Block(const std::string& key, F fn) {
+    std::string saved_key = key;
+    Field(saved_key);
+    if (saved_key.empty()) {
+        return false;
+    }
+    uint64_t len = 0;
+    if (!restore_) {
+        auto start = file_.tellp();
+        Field(len);
+        fn();
+        auto end = file_.tellp();
+        len = static_cast<uint64_t>(end - start) - sizeof(len);
+        file_.seekp(start);
+        Field(len);
+        file_.seekp(end);
+        return true;
+    }
+    Field(len);
+    if (saved_key != key) {
+        file_.seekg(static_cast<std::streamoff>(len), std::ios::cur);
+        return false;
+    }
+    auto start = file_.tellg();
+    fn();
+    if (static_cast<uint64_t>(file_.tellg() - start) != len) {
+        Fail("state of " + key + " does not match this build");
+    }
+    return true;
+}
+
+template <typename T>
+void Checkpoint::Field(std::vector<T>& vec) {
+    vec.resize(Size(vec.size()));
+    for (auto& val : vec) {
+        Field(val);
+    }
+}
+
+template <typename T>
+void Checkpoint::Field(std::deque<T>& deq) {
+    deq.resize(Size(deq.size()));
+    for (auto& val : deq) {
+        Field(val);
+    }
+}
+
+template <typename K, typename V>
+void Checkpoint::Field(std::multimap<K, V>& map) {
+    uint64_t size = Size(map.size());
+    if (!restore_) {
+        for (auto& it : map) {
+            K key = it.first;
+            Field(key);
+            Field(it.second);
+        }
+        return;
+    }
+    map.clear();
+    for (uint64_t i = 0; i < size; i++) {
+        K key;
+        V val;
+        Field(key);
+        Field(val);
+        map.emplace(key, val);
+    }
+}
+
+template <typename K, typename V>
+void Checkpoint::Field(std::unordered_map<K, V>& map) {
+    uint64_t size = Size(map.size());
+    if (!restore_) {
+        for (auto& it : map) {
+            K key = it.first;
+            Field(key);
+            Field(it.second);
+        }
+        return;
+    }
+    map.clear();
+    for (uint64_t i = 0; i < size; i++) {
+        K key;
+        Field(key);
+        Field(map[key]);
+    }
+}
+
+}  // namespace dramsim3
+#endif
@@ -17,7 +17,10 @@ CommandQueue::CommandQueue(int channel_id, const Config& config,
       is_in_ref_(false),
       queue_size_(static_cast<size_t>(config_.cmd_queue_size)),
       queue_idx_(0),
-      clk_(0) {
+      clk_(0),
+      warm_cycles_(0),
+      last_cas_rank_(-1),
+      last_cas_bankgroup_(-1) {
     if (config_.queue_structure == "PER_BANK") {
         queue_structure_ = QueueStructure::PER_BANK;
         num_queues_ = config_.banks * config_.ranks;
@@ -99,22 +102,35 @@ CommandQueue::CommandQueue(int channel_id, const Config& config,
     gs_shadow_state_.resize(num_queues_);
     // Default values are set by struct initialization
     gs_aligned_req_count_.resize(num_queues_, 0);
+    gs_warm_clk_ = 0;
 
     // ===== Row Exclusion State Init =====
     re_detect_state_.resize(num_queues_);
     // row_exclusion_store_ is already empty (deque default)
 
+    // ===== Row Hit Cap Init =====
+    row_hit_cap_.resize(num_queues_, config_.row_hit_cap);
+    cap_conflicts_.resize(num_queues_, 0);
+    cap_cas_.resize(num_queues_, 0);
+
     // ===== FAPS-3D State Init =====
     faps_bank_state_.resize(num_queues_);
 
+    // ===== DUEL Init =====
+    bank_policy_.resize(num_queues_, top_row_buf_policy_);
+    duel_winner_ = 0;
+    if (top_row_buf_policy_ == RowBufPolicy::DUEL) {
+        DUEL_AssignLeaders();
+    }
+
     // ===== DYMPL Predictor Init =====
-    if (top_row_buf_policy_ == RowBufPolicy::DYMPL) {
+    if (PolicyActive(RowBufPolicy::DYMPL)) {
         dympl_predictor_ = std::unique_ptr<DYMPLPredictor>(
             new DYMPLPredictor(num_queues_, simple_stats_));
     }
 
     // ===== RL_PAGE Agent Init =====
-    if (top_row_buf_policy_ == RowBufPolicy::RL_PAGE) {
+    if (PolicyActive(RowBufPolicy::RL_PAGE)) {
         rl_page_agent_ = std::unique_ptr<RLPageAgent>(
             new RLPageAgent(num_queues_, simple_stats_));
     }
@@ -123,9 +139,50 @@ CommandQueue::CommandQueue(int channel_id, const Config& config,
     if (top_row_buf_policy_ == RowBufPolicy::STATIC_TIMEOUT) {
         static_timeout_open_row_.resize(num_queues_, -1);
     }
+
+    // ===== Command Scheduler Init =====
+    if (config_.cmd_scheduler == "PARBS") {
+        cmd_scheduler_ = std::unique_ptr<CommandScheduler>(
+            new PARBSScheduler(config_, queues_, simple_stats_));
+    } else if (config_.cmd_scheduler == "TCM") {
+        cmd_scheduler_ = std::unique_ptr<CommandScheduler>(
+            new TCMScheduler(config_, queues_, simple_stats_));
+    } else if (config_.cmd_scheduler == "BLISS") {
+        cmd_scheduler_ = std::unique_ptr<CommandScheduler>(
+            new BLISSScheduler(config_, queues_, simple_stats_));
+    } else if (config_.cmd_scheduler == "RL") {
+        cmd_scheduler_ = std::unique_ptr<CommandScheduler>(
+            new RLScheduler(config_, queues_, simple_stats_));
+    } else if (config_.qos_mode != QoSMode::NONE) {
+        cmd_scheduler_ = std::unique_ptr<CommandScheduler>(
+            new QoSScheduler(config_, queues_, simple_stats_));
+    }
 }
 
 Command CommandQueue::GetCommandToIssue() {
+    const auto& regulator = controller_->bw_regulator_;
+    if (regulator && regulator->HasReservations()) {
+        auto cmd = GetReservedCommand();
+        if (cmd.IsValid()) {
+            return cmd;
+        }
+    }
+    if (cmd_scheduler_) {
+        return GetScheduledCommand();
+    }
+    if (config_.bankgroup_interleave && last_cas_rank_ >= 0) {
+        CMDIterator cmd_it;
+        Command cmd;
+        int q = GetInterleavedQueue(cmd_it, cmd);
+        if (q >= 0 && cmd.IsReadWrite()) {
+            // issue the very CAS the look-ahead found, the round robin scan
+            // of that queue could settle on another command
+            queue_idx_ = q;
+            OnCommandSelected(cmd_it, cmd);
+            simple_stats_.Increment("num_bg_interleave_picks");
+            return IssueRWCommand(cmd, queues_[q]);
+        }
+    }
     for (int i = 0; i < num_queues_; i++) {
         auto& queue = GetNextQueue();
         // if we're refreshing, skip the command queues that are involved
@@ -137,105 +194,218 @@ Command CommandQueue::GetCommandToIssue() {
         auto cmd = GetFirstReadyInQueue(queue);
         if (cmd.IsValid()) {
             if (cmd.IsReadWrite()) {
-                bool autoPRE_added = false;
-                //row hit count in command queue
-                int row_hit_count=0;
-                row_hit_count += std::count_if(queue.begin(),queue.end(),[&cmd](Command x){return x.Row() == cmd.Row() ;});
-
-                if(cmd.IsWrite()){
-                const auto& WB = controller_->write_buffer();
-                for(const auto& it:WB){
-                    Command cmd_it= controller_ -> TransToCommand(it);
-                    if(cmd_it.Channel()   == cmd.Channel() && 
-                       cmd_it.Rank()      == cmd.Rank()    && 
-                       cmd_it.Bankgroup() == cmd.Bankgroup() && 
-                       cmd_it.Bank()      == cmd.Bank()     &&
-                       cmd_it.Row()       == cmd.Row() &&
-                       queue.size() < queue_size_)
-                    row_hit_count ++;
-                }
-                }
-                if(cmd.IsRead()){
-                const auto& RQ = controller_->read_queue();
-                for(const auto& it:RQ){
-                    Command cmd_it= controller_ -> TransToCommand(it);
-                    if(cmd_it.Channel()   == cmd.Channel() && 
-                       cmd_it.Rank()      == cmd.Rank()    && 
-                       cmd_it.Bankgroup() == cmd.Bankgroup() && 
-                       cmd_it.Bank()      == cmd.Bank()     &&
-                       cmd_it.Row()       == cmd.Row()     && 
-                       queue.size() < queue_size_)
-                    row_hit_count ++;
-                }
-                }
+                cmd = IssueRWCommand(cmd, queue);
+            }
+            return cmd;
+        }
+    }
+    return Command();
+}
 
-                //end of row hit command cluster
-                if(row_hit_count==1){
-                    if(row_buf_policy_[queue_idx_] == RowBufPolicy::SMART_CLOSE){
-                        cmd.cmd_type = cmd.cmd_type==CommandType::READ ? CommandType::READ_PRECHARGE:
-                                       cmd.cmd_type==CommandType::WRITE? CommandType::WRITE_PRECHARGE:cmd.cmd_type;
-                        autoPRE_added=true;
-                    }
-                    else if(top_row_buf_policy_==RowBufPolicy::GS || top_row_buf_policy_==RowBufPolicy::GS_NOHOTROW){
-                        //clock starts ticking
-                        //do not block other row conflicting request if they are already in the queue
-                        if(queues_[queue_idx_].size()==1){
-                            timeout_ticking[queue_idx_]=true;
-                            timeout_counter[queue_idx_]=GetCurrentTimeout(queue_idx_);  // Use dynamic timeout
-                            issued_cmd[queue_idx_]=cmd;
-                        }
-                    }
-                    else if(top_row_buf_policy_==RowBufPolicy::DYMPL){
-                        // DYMPL: perceptron-based open/close decision
-                        bool keep_open = dympl_predictor_->Predict(queue_idx_, cmd.Row(), cmd.Column());
-                        if(!keep_open){
-                            cmd.cmd_type = cmd.cmd_type==CommandType::READ ? CommandType::READ_PRECHARGE:
-                                           cmd.cmd_type==CommandType::WRITE? CommandType::WRITE_PRECHARGE:cmd.cmd_type;
-                            autoPRE_added=true;
-                        }
-                    }
-                    else if(top_row_buf_policy_==RowBufPolicy::RL_PAGE){
-                        // RL_PAGE: SARSA+CMAC open/close decision
-                        int rd_q = static_cast<int>(controller_->read_queue().size());
-                        int wr_q = static_cast<int>(controller_->write_buffer().size());
-                        int bk_q = static_cast<int>(queues_[queue_idx_].size());
-                        int rh = channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
-                        int sr = row_hit_count;  // same-row pending count
-
-                        int action = rl_page_agent_->Decide(
-                            queue_idx_, cmd.Row(), rd_q, wr_q, bk_q, rh, sr);
-
-                        if (action == 0) {  // CLOSE
-                            cmd.cmd_type = cmd.cmd_type==CommandType::READ ? CommandType::READ_PRECHARGE:
-                                           cmd.cmd_type==CommandType::WRITE? CommandType::WRITE_PRECHARGE:cmd.cmd_type;
-                            autoPRE_added=true;
-                        }
-                        // action == 1: KEEP_OPEN, don't modify cmd
-                    }
-                    // Static Timeout: start timer when last row hit is issued
-                    else if(top_row_buf_policy_==RowBufPolicy::STATIC_TIMEOUT){
-                        // This is the last request for this row, start static timeout
-                        timeout_ticking[queue_idx_]=true;
-                        timeout_counter[queue_idx_]=config_.static_timeout_cycles_;
-                        issued_cmd[queue_idx_]=cmd;
-                        static_timeout_open_row_[queue_idx_]=cmd.Row();
-                    }
-                }
+Command CommandQueue::GetReservedCommand() {
+    // sources with reservation tokens left go before everyone else
+    const auto& regulator = controller_->bw_regulator_;
+    for (int q = 0; q < num_queues_; q++) {
+        if (is_in_ref_ && ref_q_indices_.find(q) != ref_q_indices_.end()) {
+            continue;
+        }
+        auto& queue = queues_[q];
+        for (auto cmd_it = queue.begin(); cmd_it != queue.end(); cmd_it++) {
+            if (!regulator->Reserved(cmd_it->source_id)) {
+                continue;
+            }
+            Command cmd = GetIssuableCommand(cmd_it, queue, q);
+            if (!cmd.IsValid()) {
+                continue;
+            }
+            queue_idx_ = q;
+            OnCommandSelected(cmd_it, cmd);
+            simple_stats_.Increment("num_bw_reserved_picks");
+            if (cmd.IsReadWrite()) {
+                cmd = IssueRWCommand(cmd, queue);
+            }
+            return cmd;
+        }
+    }
+    return Command();
+}
 
-                EraseRWCommand(cmd,autoPRE_added);
-                //compute total rw command count for each bank
-                total_command_count_[queue_idx_]++;
+Command CommandQueue::GetScheduledCommand() {
+    // gather every issuable command of the channel and let the scheduler pick
+    std::vector<SchedCandidate> cands;
+    for (int q = 0; q < num_queues_; q++) {
+        if (is_in_ref_ && ref_q_indices_.find(q) != ref_q_indices_.end()) {
+            continue;
+        }
+        auto& queue = queues_[q];
+        for (auto cmd_it = queue.begin(); cmd_it != queue.end(); cmd_it++) {
+            Command cmd = GetIssuableCommand(cmd_it, queue, q);
+            if (!cmd.IsValid()) {
+                continue;
+            }
+            SchedCandidate cand;
+            cand.queue_idx = q;
+            cand.cmd_idx = static_cast<int>(cmd_it - queue.begin());
+            cand.cmd = cmd;
+            cand.source_id = cmd_it->source_id;
+            cand.arrival = cmd_it->added_cycle;
+            cand.row_hit = cmd.IsReadWrite();
+            cand.qos_class = cmd_it->qos_class;
+            cand.deadline = cmd_it->deadline;
+            cands.push_back(cand);
+        }
+    }
+    if (cands.empty()) {
+        return Command();
+    }
 
-                // FAPS: Track access for potential hit counting
-                if (top_row_buf_policy_ == RowBufPolicy::FAPS) {
-                    FAPS_TrackAccess(queue_idx_, cmd.Row());
-                }
+    const auto& pick = cands[cmd_scheduler_->Select(cands, clk_)];
+    queue_idx_ = pick.queue_idx;
+    auto& queue = queues_[queue_idx_];
+    OnCommandSelected(queue.begin() + pick.cmd_idx, pick.cmd);
+    cmd_scheduler_->OnIssue(pick);
+    Command cmd = pick.cmd;
+    if (cmd.IsReadWrite()) {
+        cmd = IssueRWCommand(cmd, queue);
+    }
+    return cmd;
+}
 
+int CommandQueue::GetInterleavedQueue(CMDIterator& pick_it, Command& pick) {
+    // the round robin pick is a CAS to the bank group of the last CAS, look
+    // further for a ready CAS to another bank group of the same rank
+    bool rr_pick_seen = false;
+    for (int i = 1; i <= num_queues_; i++) {
+        int q = (queue_idx_ + i) % num_queues_;
+        if (is_in_ref_ && ref_q_indices_.find(q) != ref_q_indices_.end()) {
+            continue;
+        }
+        auto& queue = queues_[q];
+        Command cmd;
+        auto cmd_it = queue.begin();
+        for (; cmd_it != queue.end(); cmd_it++) {
+            cmd = GetIssuableCommand(cmd_it, queue, q);
+            if (cmd.IsValid()) {
+                break;
             }
-            return cmd;
+        }
+        if (!cmd.IsValid()) {
+            continue;
+        }
+        bool same_rank = cmd.IsReadWrite() && cmd.Rank() == last_cas_rank_;
+        bool same_bg = same_rank && cmd.Bankgroup() == last_cas_bankgroup_;
+        if (!rr_pick_seen) {
+            if (!same_bg) {
+                return -1;
+            }
+            rr_pick_seen = true;
+        } else if (same_rank && !same_bg) {
+            pick_it = cmd_it;
+            pick = cmd;
+            return q;
         }
     }
-    return Command();
+    return -1;
+}
+
+Command CommandQueue::IssueRWCommand(Command cmd, CMDQueue& queue) {
+    bool autoPRE_added = false;
+    last_cas_rank_ = cmd.Rank();
+    last_cas_bankgroup_ = cmd.Bankgroup();
+    //row hit count in command queue
+    int row_hit_count=0;
+    row_hit_count += std::count_if(queue.begin(),queue.end(),[&cmd](Command x){return x.Row() == cmd.Row() ;});
+
+    if(cmd.IsWrite()){
+        const auto& WB = controller_->write_buffer();
+        for(const auto& it:WB){
+            Command cmd_it= controller_ -> TransToCommand(it);
+            if(cmd_it.Channel()   == cmd.Channel() && 
+               cmd_it.Rank()      == cmd.Rank()    && 
+               cmd_it.Bankgroup() == cmd.Bankgroup() && 
+               cmd_it.Bank()      == cmd.Bank()     &&
+               cmd_it.Row()       == cmd.Row() &&
+               queue.size() < queue_size_)
+                row_hit_count ++;
+        }
+    }
+    if(cmd.IsRead()){
+        const auto& RQ = controller_->read_queue();
+        for(const auto& it:RQ){
+            Command cmd_it= controller_ -> TransToCommand(it);
+            if(cmd_it.Channel()   == cmd.Channel() && 
+               cmd_it.Rank()      == cmd.Rank()    && 
+               cmd_it.Bankgroup() == cmd.Bankgroup() && 
+               cmd_it.Bank()      == cmd.Bank()     &&
+               cmd_it.Row()       == cmd.Row()     && 
+               queue.size() < queue_size_)
+                row_hit_count ++;
+        }
+    }
+
+    //end of row hit command cluster
+    if(row_hit_count==1){
+        if(row_buf_policy_[queue_idx_] == RowBufPolicy::SMART_CLOSE){
+            cmd.cmd_type = cmd.cmd_type==CommandType::READ ? CommandType::READ_PRECHARGE:
+                           cmd.cmd_type==CommandType::WRITE? CommandType::WRITE_PRECHARGE:cmd.cmd_type;
+            autoPRE_added=true;
+        }
+        else if(bank_policy_[queue_idx_]==RowBufPolicy::GS || bank_policy_[queue_idx_]==RowBufPolicy::GS_NOHOTROW){
+            //clock starts ticking
+            //do not block other row conflicting request if they are already in the queue
+            if(queues_[queue_idx_].size()==1){
+                timeout_ticking[queue_idx_]=true;
+                timeout_counter[queue_idx_]=GetCurrentTimeout(queue_idx_);  // Use dynamic timeout
+                issued_cmd[queue_idx_]=cmd;
+            }
+        }
+        else if(bank_policy_[queue_idx_]==RowBufPolicy::DYMPL){
+            // DYMPL: perceptron-based open/close decision
+            bool keep_open = dympl_predictor_->Predict(
+                queue_idx_, cmd.Row(), cmd.Column(), RowHotness(cmd));
+            if(!keep_open){
+                cmd.cmd_type = cmd.cmd_type==CommandType::READ ? CommandType::READ_PRECHARGE:
+                               cmd.cmd_type==CommandType::WRITE? CommandType::WRITE_PRECHARGE:cmd.cmd_type;
+                autoPRE_added=true;
+            }
+        }
+        else if(bank_policy_[queue_idx_]==RowBufPolicy::RL_PAGE){
+            // RL_PAGE: SARSA+CMAC open/close decision
+            int rd_q = static_cast<int>(controller_->read_queue().size());
+            int wr_q = static_cast<int>(controller_->write_buffer().size());
+            int bk_q = static_cast<int>(queues_[queue_idx_].size());
+            int rh = channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
+            int sr = row_hit_count;  // same-row pending count
+
+            int action = rl_page_agent_->Decide(
+                queue_idx_, cmd.Row(), rd_q, wr_q, bk_q, rh, sr);
+
+            if (action == 0) {  // CLOSE
+                cmd.cmd_type = cmd.cmd_type==CommandType::READ ? CommandType::READ_PRECHARGE:
+                               cmd.cmd_type==CommandType::WRITE? CommandType::WRITE_PRECHARGE:cmd.cmd_type;
+                autoPRE_added=true;
+            }
+            // action == 1: KEEP_OPEN, don't modify cmd
+        }
+        // Static Timeout: start timer when last row hit is issued
+        else if(bank_policy_[queue_idx_]==RowBufPolicy::STATIC_TIMEOUT){
+            // This is the last request for this row, start static timeout
+            timeout_ticking[queue_idx_]=true;
+            timeout_counter[queue_idx_]=config_.static_timeout_cycles_;
+            issued_cmd[queue_idx_]=cmd;
+            static_timeout_open_row_[queue_idx_]=cmd.Row();
+        }
+    }
+
+    EraseRWCommand(cmd,autoPRE_added);
+    //compute total rw command count for each bank
+    total_command_count_[queue_idx_]++;
+
+    // FAPS: Track access for potential hit counting
+    if (bank_policy_[queue_idx_] == RowBufPolicy::FAPS) {
+        FAPS_TrackAccess(queue_idx_, cmd.Row());
+    }
+    return cmd;
 }
 
 void CommandQueue::ArbitratePagePolicy(){
@@ -340,7 +510,7 @@ Command CommandQueue::FinishRefresh() {
             // FAPS uses per-bank access-count epoch; do NOT reset
             // counters on refresh, otherwise the epoch threshold
             // (1000 accesses) can never be reached between refreshes.
-            if (top_row_buf_policy_ != RowBufPolicy::FAPS) {
+            if (bank_policy_[i] != RowBufPolicy::FAPS) {
                 total_command_count_[i]=0;
                 true_row_hit_count_[i]=0;
                 demand_row_hit_count_[i]=0;
@@ -379,19 +549,76 @@ bool CommandQueue::ArbitratePrecharge(const CMDIterator& cmd_it,
 
     bool rowhit_limit_reached =
         channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(), cmd.Bank()) >=
-        4;
-    if (!pending_row_hits_exist || rowhit_limit_reached) {
-        simple_stats_.Increment("num_ondemand_pres");
+        row_hit_cap_[GetQueueIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank())];
+    if (!pending_row_hits_exist || rowhit_limit_reached || IsAged(cmd)) {
         return true;
     }
     return false;
 }
 
+bool CommandQueue::IsAged(const Command& cmd) const {
+    return config_.max_request_age > 0 &&
+           clk_ - cmd.added_cycle >=
+               static_cast<uint64_t>(config_.max_request_age);
+}
+
+bool CommandQueue::HasAgedConflictAhead(const CMDIterator& cmd_it,
+                                        const CMDQueue& queue) const {
+    // only the oldest request of a bank may precharge it, see
+    // ArbitratePrecharge
+    for (auto it = queue.begin(); it != cmd_it; it++) {
+        if (it->Rank() == cmd_it->Rank() &&
+            it->Bankgroup() == cmd_it->Bankgroup() &&
+            it->Bank() == cmd_it->Bank()) {
+            return IsAged(*it) &&
+                   it->Row() != channel_state_.OpenRow(
+                                    it->Rank(), it->Bankgroup(), it->Bank());
+        }
+    }
+    return false;
+}
+
+void CommandQueue::AdaptRowHitCap() {
+    for (int i = 0; i < num_queues_; i++) {
+        uint64_t oldest_age = 0;
+        for (const auto& cmd : queues_[i]) {
+            oldest_age = std::max(oldest_age, clk_ - cmd.added_cycle);
+        }
+        if (oldest_age > static_cast<uint64_t>(config_.row_hit_cap_age_threshold)) {
+            // someone is starving behind the open row
+            if (row_hit_cap_[i] > config_.row_hit_cap_min) {
+                row_hit_cap_[i] = std::max(config_.row_hit_cap_min, row_hit_cap_[i] / 2);
+                simple_stats_.Increment("row_hit_cap_shrinks");
+            }
+        } else if (cap_cas_[i] > 0 &&
+                   cap_conflicts_[i] * ROW_HIT_CAP_RARE_CONFLICT_RATIO < cap_cas_[i]) {
+            if (row_hit_cap_[i] < config_.row_hit_cap_max) {
+                row_hit_cap_[i]++;
+                simple_stats_.Increment("row_hit_cap_grows");
+            }
+        }
+        cap_conflicts_[i] = 0;
+        cap_cas_[i] = 0;
+    }
+}
+
 bool CommandQueue::WillAcceptCommand(int rank, int bankgroup, int bank) const {
     int q_idx = GetQueueIndex(rank, bankgroup, bank);
     return queues_[q_idx].size() < queue_size_;
 }
 
+bool CommandQueue::HasRowInQueue(int rank, int bankgroup, int bank,
+                                 int row) const {
+    const auto& queue = queues_[GetQueueIndex(rank, bankgroup, bank)];
+    for (const auto& cmd : queue) {
+        if ((row < 0 || cmd.Row() == row) && cmd.Bank() == bank &&
+            cmd.Bankgroup() == bankgroup && cmd.Rank() == rank) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool CommandQueue::QueueEmpty() const {
     for (const auto& q : queues_) {
         if (!q.empty()) {
@@ -407,15 +634,17 @@ bool CommandQueue::AddCommand(Command cmd) {
     if (queue.size() < queue_size_) {
         queue.push_back(cmd);
         rank_q_empty[cmd.Rank()] = false;
+        RowBufPolicy policy =
+            bank_policy_[GetQueueIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank())];
 
-        if(top_row_buf_policy_==RowBufPolicy::GS || top_row_buf_policy_==RowBufPolicy::GS_NOHOTROW){
+        if(policy==RowBufPolicy::GS || policy==RowBufPolicy::GS_NOHOTROW){
             //whenever a new command comes, reset the timeout ticking for this bank
             int index=GetQueueIndex(cmd.Rank(),cmd.Bankgroup(),cmd.Bank());
 
             // timeout clock is still ticking, and a new command arrives
             if(timeout_ticking[index] && timeout_counter[index]>0){
                 if(cmd.Row() != issued_cmd[index].Row()){
-                    if (top_row_buf_policy_ == RowBufPolicy::GS) {
+                    if (policy == RowBufPolicy::GS) {
                         // Row conflict: check if row exclusion entry should be marked as causing conflict
                         // Paper Section 4.2: track entries that caused conflicts for replacement policy
                         if (RE_IsInStore(cmd.Rank(), cmd.Bankgroup(), cmd.Bank(), issued_cmd[index].Row())) {
@@ -432,92 +661,9 @@ bool CommandQueue::AddCommand(Command cmd) {
                 }
             }
         }
-        else if(top_row_buf_policy_==RowBufPolicy::ABP){
-            // ABP doesn't use timeouts, conflicts are handled naturally via on-demand precharge.
-            // The feedback is given in ABP_ProcessACT when the new row activates.
-        }
-        else if(top_row_buf_policy_==RowBufPolicy::CRAFT){
-            int index=GetQueueIndex(cmd.Rank(),cmd.Bankgroup(),cmd.Bank());
-
-            if(timeout_ticking[index] && timeout_counter[index] > 0){
-                if(cmd.Row() != issued_cmd[index].Row()){
-                    // Conflict: timeout too long, de-escalate
-                    auto& state = craft_state_[index];
-
-                    // [PR] Phase Reset: track consecutive conflicts
-                    if (CRAFT_PHASE_RESET_ENABLED) {
-                        state.conflict_streak = std::min(state.conflict_streak + 1, CRAFT_REOPEN_STREAK_MAX);
-                        if (state.conflict_streak >= CRAFT_PHASE_THRESHOLD) {
-                            // Phase change detected: fast reset to initial timeout
-                            state.timeout_value = CRAFT_INIT_TIMEOUT;
-                            state.conflict_streak = 0;
-                            state.reopen_streak = 0;
-                            simple_stats_.Increment("craft_phase_resets");
-                            goto craft_conflict_done;
-                        }
-                    }
-
-                    {
-                        // Compute de-escalation step
-                        int step = craft_conflict_step_;
-
-                        // [QDSD] Scale step by queue depth
-                        if (CRAFT_QDSD_ENABLED) {
-                            int pending = static_cast<int>(queues_[index].size());
-                            int scale = std::min(pending, CRAFT_QDSD_SCALE_CAP);
-                            step *= scale;
-                            simple_stats_.IncrementVec("craft_qdsd_scale_dist", std::min(scale, 4));
-                        }
-
-                        // [RW] Read conflict: double step for faster de-escalation
-                        if (CRAFT_RW_ENABLED && cmd.IsRead()) {
-                            step *= 2;
-                            simple_stats_.Increment("craft_conflict_read");
-                        } else if (CRAFT_RW_ENABLED) {
-                            simple_stats_.Increment("craft_conflict_write");
-                        }
-
-                        state.timeout_value = std::max(state.timeout_value - step, CRAFT_T_MIN);
-                    }
-
-                    craft_conflict_done:
-                    state.reopen_streak = 0;
-                    state.right_streak = 0;   // [RS] conflict breaks right streak
-                    timeout_counter[index] = 0;  // trigger immediate precharge
-                    simple_stats_.Increment("craft_conflicts");
-                    simple_stats_.Increment("craft_deescalations");
-                }
-                else{
-                    // Row hit during timeout: reset timer, keep row open
-                    timeout_counter[index] = craft_state_[index].timeout_value;
-                    timeout_ticking[index] = false;
-                }
-            }
-        }
-        else if(top_row_buf_policy_==RowBufPolicy::INTEL_ADAPTIVE){
-            int index=GetQueueIndex(cmd.Rank(),cmd.Bankgroup(),cmd.Bank());
-
-            if(timeout_ticking[index] && timeout_counter[index] > 0){
-                if(cmd.Row() != issued_cmd[index].Row()){
-                    // Conflict: should have closed sooner => MC--
-                    auto& istate = intap_state_[index];
-                    if (istate.mistake_counter > 0) {
-                        istate.mistake_counter--;
-                    }
-                    simple_stats_.Increment("intap_conflicts");
-                    // Force early timeout
-                    timeout_counter[index] = 0;
-                }
-                else{
-                    // Row hit during timeout: reset timer, keep row open
-                    timeout_counter[index] = intap_state_[index].timeout_register;
-                    timeout_ticking[index] = false;
-                }
-            }
-        }
 
         // Static Timeout: handle new request arrival
-        if(top_row_buf_policy_==RowBufPolicy::STATIC_TIMEOUT){
+        if(policy==RowBufPolicy::STATIC_TIMEOUT){
             int index=GetQueueIndex(cmd.Rank(),cmd.Bankgroup(),cmd.Bank());
 
             if(timeout_ticking[index] && timeout_counter[index]>0){
@@ -580,79 +726,146 @@ CMDQueue& CommandQueue::GetQueue(int rank, int bankgroup, int bank) {
 }
 
 Command CommandQueue::GetFirstReadyInQueue(CMDQueue& queue)  {
+    // with prefetch_aware a ready prefetch is only taken if no demand is ready
+    auto picked = queue.end();
+    Command picked_cmd;
     for (auto cmd_it = queue.begin(); cmd_it != queue.end(); cmd_it++) {
-        Command cmd = channel_state_.GetReadyCommand(*cmd_it, clk_);
+        Command cmd = GetIssuableCommand(cmd_it, queue, queue_idx_);
         if (!cmd.IsValid()) {
             continue;
         }
+        if (config_.prefetch_aware && cmd_it->is_prefetch) {
+            if (picked == queue.end()) {
+                picked = cmd_it;
+                picked_cmd = cmd;
+            }
+            continue;
+        }
+        picked = cmd_it;
+        picked_cmd = cmd;
+        break;
+    }
+    if (picked == queue.end()) {
+        return Command();
+    }
+    OnCommandSelected(picked, picked_cmd);
+    return picked_cmd;
+}
 
-        // === Static Timeout blocking check ===
-        if (ShouldBlockForStaticTimeout(queue_idx_, cmd)) {
-            continue;  // Block this command, try next
+void CommandQueue::UpgradePrefetch(int rank, int bankgroup, int bank,
+                                   uint64_t hex_addr) {
+    for (auto& cmd : GetQueue(rank, bankgroup, bank)) {
+        if (cmd.hex_addr == hex_addr && cmd.IsRead()) {
+            cmd.is_prefetch = false;
         }
+    }
+}
 
-        //compute true row_hit command targeting open row or victim rows
-        bool true_row_hit=false;
-        // means cmd is a row hit command
-        if(cmd.IsReadWrite()){
-            // will not happen in normal case
-            // if a read does not return, issuing write to the same address is absurd
-            if(cmd.IsWrite() && HasRWDependency(cmd_it, queue)){
-                continue;
-            }
-            if (cmd_it->induced_precharge) {
-                // row hit already counted when its precharge was scheduled
-                cmd_it->induced_precharge = false;
-            } else {
-                true_row_hit=true;
-                demand_row_hit_count_[queue_idx_]++;
-            }
+Command CommandQueue::GetIssuableCommand(const CMDIterator& cmd_it,
+                                         const CMDQueue& queue,
+                                         int queue_idx) const {
+    Command cmd = channel_state_.GetReadyCommand(*cmd_it, clk_);
+    if (!cmd.IsValid()) {
+        return Command();
+    }
 
-            // GS: Process CAS command for shadow simulation
-            if (top_row_buf_policy_ == RowBufPolicy::GS || top_row_buf_policy_ == RowBufPolicy::GS_NOHOTROW) {
-                GS_ProcessCAS(queue_idx_, clk_);
-            }
-            // DYMPL: Update features on CAS
-            if (top_row_buf_policy_ == RowBufPolicy::DYMPL) {
-                dympl_predictor_->UpdateOnCAS(queue_idx_, cmd.Row(), cmd.Column(), true_row_hit);
-            }
+    // === Static Timeout blocking check ===
+    if (ShouldBlockForStaticTimeout(queue_idx, cmd)) {
+        return Command();
+    }
+
+    if (cmd.IsReadWrite()) {
+        // source over its bandwidth limit
+        const auto& regulator = controller_->bw_regulator_;
+        if (regulator && regulator->Limited(cmd_it->source_id)) {
+            return Command();
         }
-        else if (cmd.cmd_type == CommandType::ACTIVATE) {
-            // GS: Process ACT command for shadow simulation
-            if (top_row_buf_policy_ == RowBufPolicy::GS || top_row_buf_policy_ == RowBufPolicy::GS_NOHOTROW) {
-                GS_ProcessACT(queue_idx_, cmd.Row(), clk_);
-            }
-            // DYMPL: Train on ACT (before feature update)
-            if (top_row_buf_policy_ == RowBufPolicy::DYMPL) {
-                dympl_predictor_->TrainOnACT(queue_idx_, cmd.Row());
-                dympl_predictor_->UpdateOnACT(queue_idx_, cmd.Row());
-            }
-            // RL_PAGE: Reward feedback on ACT (KEEP_OPEN → conflict detection)
-            if (top_row_buf_policy_ == RowBufPolicy::RL_PAGE) {
-                rl_page_agent_->OnActivate(queue_idx_, cmd.Row());
-            }
+        // will not happen in normal case
+        // if a read does not return, issuing write to the same address is absurd
+        if (cmd.IsWrite() && HasRWDependency(cmd_it, queue)) {
+            return Command();
         }
-        else if (cmd.cmd_type == CommandType::PRECHARGE) {
-            if (!ArbitratePrecharge(cmd_it, queue)) {
-                continue;
-            }
-            cmd_it->induced_precharge = true;
-            //check victim_cmds to verify whether cmd_it can be a possible row hit
-           // for(auto& v:victim_cmds_[queue_idx_]){
-           //     if(v.Row() == cmd_it->Row()){
-           //         true_row_hit=true;
-           //     }
-           // }
-            //if precharge occurs, it means switching rows
-            victim_cmds_[queue_idx_].push_back(cmd);
+        // hits behind an aged conflict would keep pushing its PRE out by
+        // tRTP/tWR, hold them until the row is closed
+        if (config_.max_request_age > 0 &&
+            HasAgedConflictAhead(cmd_it, queue)) {
+            return Command();
+        }
+    } else if (cmd.cmd_type == CommandType::PRECHARGE) {
+        if (!ArbitratePrecharge(cmd_it, queue)) {
+            return Command();
+        }
+    }
+    return cmd;
+}
+
+void CommandQueue::OnCommandSelected(const CMDIterator& cmd_it,
+                                     const Command& cmd) {
+    //compute true row_hit command targeting open row or victim rows
+    bool true_row_hit=false;
+    // means cmd is a row hit command
+    if(cmd.IsReadWrite()){
+        if (cmd_it->induced_precharge) {
+            // row hit already counted when its precharge was scheduled
+            cmd_it->induced_precharge = false;
+        } else {
+            true_row_hit=true;
+            demand_row_hit_count_[queue_idx_]++;
         }
 
-        if(true_row_hit){
-            true_row_hit_count_[queue_idx_]++;
+        cap_cas_[queue_idx_]++;
+
+        // GS: Process CAS command for shadow simulation
+        if (bank_policy_[queue_idx_] == RowBufPolicy::GS || bank_policy_[queue_idx_] == RowBufPolicy::GS_NOHOTROW) {
+            GS_ProcessCAS(queue_idx_, clk_ + warm_cycles_);
+        }
+        // DYMPL: Update features on CAS
+        if (bank_policy_[queue_idx_] == RowBufPolicy::DYMPL) {
+            dympl_predictor_->UpdateOnCAS(queue_idx_, cmd.Row(), cmd.Column(), true_row_hit);
+        }
+    }
+    else if (cmd.cmd_type == CommandType::ACTIVATE) {
+        // GS: Process ACT command for shadow simulation
+        if (bank_policy_[queue_idx_] == RowBufPolicy::GS || bank_policy_[queue_idx_] == RowBufPolicy::GS_NOHOTROW) {
+            GS_ProcessACT(queue_idx_, cmd.Row(), clk_ + warm_cycles_);
+        }
+        // DYMPL: Train on ACT (before feature update)
+        if (bank_policy_[queue_idx_] == RowBufPolicy::DYMPL) {
+            dympl_predictor_->TrainOnACT(queue_idx_, cmd.Row());
+            dympl_predictor_->UpdateOnACT(queue_idx_, cmd.Row());
+        }
+        // RL_PAGE: Reward feedback on ACT (KEEP_OPEN → conflict detection)
+        if (bank_policy_[queue_idx_] == RowBufPolicy::RL_PAGE) {
+            rl_page_agent_->OnActivate(queue_idx_, cmd.Row());
+        }
+    }
+    else if (cmd.cmd_type == CommandType::PRECHARGE) {
+        simple_stats_.Increment("num_ondemand_pres");
+        cap_conflicts_[queue_idx_]++;
+        if (IsAged(*cmd_it) &&
+            channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(), cmd.Bank()) <
+                row_hit_cap_[queue_idx_]) {
+            simple_stats_.Increment("num_aged_promotions");
+        }
+        cmd_it->induced_precharge = true;
+        //if precharge occurs, it means switching rows
+        victim_cmds_[queue_idx_].push_back(cmd);
+    }
+
+    if(true_row_hit){
+        true_row_hit_count_[queue_idx_]++;
+    }
+
+    if (top_row_buf_policy_ == RowBufPolicy::DUEL &&
+        duel_leader_of_[queue_idx_] >= 0) {
+        if (true_row_hit) {
+            simple_stats_.IncrementVec("duel_leader_row_hits",
+                                       duel_leader_of_[queue_idx_]);
+        } else if (cmd.cmd_type == CommandType::PRECHARGE) {
+            simple_stats_.IncrementVec("duel_leader_conflicts",
+                                       duel_leader_of_[queue_idx_]);
         }
-        return cmd;
     }
-    return Command();
 }
 
 void CommandQueue::EraseRWCommand(const Command& cmd,bool autoPRE_added) {
@@ -711,6 +924,9 @@ bool CommandQueue::HasRWDependency(const CMDIterator& cmd_it,
 
 void CommandQueue::ClockTick() {
     clk_ += 1;
+    if (config_.adaptive_row_hit_cap && clk_ % ROW_HIT_CAP_EPOCH == 0) {
+        AdaptRowHitCap();
+    }
     if(top_row_buf_policy_==RowBufPolicy::DPM){
         ArbitratePagePolicy();
         int max_len = 0;
@@ -724,13 +940,18 @@ void CommandQueue::ClockTick() {
         simple_stats_.AddValue("max_victim_queue_len", max_len);
     }
     // GS timeout arbitration
-    if(top_row_buf_policy_==RowBufPolicy::GS || top_row_buf_policy_==RowBufPolicy::GS_NOHOTROW){
+    if(PolicyActive(RowBufPolicy::GS) || PolicyActive(RowBufPolicy::GS_NOHOTROW)){
         GS_ArbitrateTimeout();
     }
     // FAPS arbitration
-    if(top_row_buf_policy_==RowBufPolicy::FAPS){
+    if(PolicyActive(RowBufPolicy::FAPS)){
         FAPS_ArbitratePagePolicy();
     }
+    // DUEL: followers switch to the best leader policy
+    if (top_row_buf_policy_ == RowBufPolicy::DUEL &&
+        clk_ % static_cast<uint64_t>(config_.duel_epoch) == 0) {
+        DUEL_ArbitratePolicy();
+    }
 }
 
 // ===== GS Timeout Update Functions =====
@@ -749,7 +970,7 @@ void CommandQueue::GetBankFromIndex(int queue_idx, int& rank, int& bankgroup, in
 }
 
 int CommandQueue::GetCurrentTimeout(int queue_idx) const {
-    if (top_row_buf_policy_ == RowBufPolicy::STATIC_TIMEOUT) {
+    if (bank_policy_[queue_idx] == RowBufPolicy::STATIC_TIMEOUT) {
         return config_.static_timeout_cycles_;  // Return fixed value
     }
     // GS policy returns dynamic value
@@ -758,7 +979,7 @@ int CommandQueue::GetCurrentTimeout(int queue_idx) const {
 
 bool CommandQueue::ShouldBlockForStaticTimeout(int queue_idx, const Command& cmd) const {
     // Only effective during STATIC_TIMEOUT policy when timer is running
-    if (top_row_buf_policy_ != RowBufPolicy::STATIC_TIMEOUT) {
+    if (bank_policy_[queue_idx] != RowBufPolicy::STATIC_TIMEOUT) {
         return false;
     }
 
@@ -825,7 +1046,7 @@ void CommandQueue::GS_ProcessACT(int queue_idx, int new_row, uint64_t curr_cycle
 
     // Row Exclusion Detection (Paper Section 4.2):
     // Only active for GS, skipped for GS_NOHOTROW (ablation: no hot row exclusion)
-    if (top_row_buf_policy_ == RowBufPolicy::GS) {
+    if (bank_policy_[queue_idx] == RowBufPolicy::GS) {
         if (detect.prev_closed_by_timeout && detect.prev_row == new_row) {
             RowExclusionEntry entry;
             entry.rank = rank;
@@ -937,12 +1158,23 @@ void CommandQueue::GS_ArbitrateTimeout() {
 
     // Original GS/GS_NOHOTROW: cycle-based global arbitration check
     if (!is_aligned) {
-        if (clk_ % GS_ARBITRATION_PERIOD != 0 || clk_ < GS_ARBITRATION_PERIOD) {
+        uint64_t clk = clk_ + warm_cycles_;
+        if (clk % GS_ARBITRATION_PERIOD != 0 || clk < GS_ARBITRATION_PERIOD) {
             return;
         }
+        gs_warm_clk_ = clk;
     }
+    GS_SelectTimeouts();
+}
 
+void CommandQueue::GS_SelectTimeouts() {
+    bool is_aligned = (top_row_buf_policy_ == RowBufPolicy::GS_ALIGNED);
     for (int q = 0; q < num_queues_; q++) {
+        // DUEL banks running another policy
+        if (bank_policy_[q] != RowBufPolicy::GS &&
+            bank_policy_[q] != RowBufPolicy::GS_NOHOTROW && !is_aligned) {
+            continue;
+        }
         // GS_ALIGNED: per-bank request-based arbitration (Paper Table 2: 30000 requests)
         if (is_aligned) {
             if (gs_aligned_req_count_[q] < GS_ALIGNED_ARBITRATION_REQUESTS) {
@@ -1078,6 +1310,9 @@ void CommandQueue::FAPS_TrackAccess(int queue_idx, int row) {
 
 void CommandQueue::FAPS_ArbitratePagePolicy() {
     for (int i = 0; i < num_queues_; i++) {
+        if (bank_policy_[i] != RowBufPolicy::FAPS) {
+            continue;
+        }
         // Per-bank epoch: only trigger when access count reaches threshold
         if (total_command_count_[i] < FAPS_EPOCH_ACCESSES) {
             continue;
@@ -1155,4 +1390,252 @@ void CommandQueue::RE_RemoveEntry(int rank, int bankgroup, int bank, int row) {
     }
 }
 
+// ===== DYMPL Functions =====
+
+uint32_t CommandQueue::RowHotness(const Command& cmd) const {
+    int bank_idx =
+        controller_->BankIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
+    return controller_->row_tracker().Hotness(bank_idx, cmd.Row());
+}
+
+// ===== DUEL Set Dueling =====
+
+bool CommandQueue::PolicyActive(RowBufPolicy policy) const {
+    if (top_row_buf_policy_ != RowBufPolicy::DUEL) {
+        return top_row_buf_policy_ == policy;
+    }
+    // leaders keep their candidate, so every candidate stays in use
+    const auto& cands = config_.duel_policies;
+    return std::find(cands.begin(), cands.end(), policy) != cands.end();
+}
+
+void CommandQueue::DUEL_AssignLeaders() {
+    int num_cands = static_cast<int>(config_.duel_policies.size());
+    int leaders = config_.duel_leaders;
+    if (num_cands * leaders > num_queues_) {
+        leaders = num_queues_ / num_cands;
+        if (leaders < 1) {
+            std::cerr << "DUEL needs at least one bank queue per candidate"
+                      << std::endl;
+            AbruptExit(__FILE__, __LINE__);
+        }
+        std::cerr << "Warning: too few banks for duel_leaders, using "
+                  << leaders << std::endl;
+    }
+    duel_reads_.resize(num_cands, 0);
+    duel_latency_.resize(num_cands, 0);
+    duel_leader_of_.resize(num_queues_, -1);
+    // spread leaders of different candidates over the bank groups
+    int num_leaders = num_cands * leaders;
+    for (int k = 0; k < leaders; k++) {
+        for (int c = 0; c < num_cands; c++) {
+            int q = (k * num_cands + c) * num_queues_ / num_leaders;
+            duel_leader_of_[q] = c;
+        }
+    }
+    for (int q = 0; q < num_queues_; q++) {
+        int c = duel_leader_of_[q] >= 0 ? duel_leader_of_[q] : duel_winner_;
+        DUEL_SetBankPolicy(q, config_.duel_policies[c]);
+    }
+}
+
+void CommandQueue::DUEL_SetBankPolicy(int queue_idx, RowBufPolicy policy) {
+    bank_policy_[queue_idx] = policy;
+    row_buf_policy_[queue_idx] = policy == RowBufPolicy::SMART_CLOSE
+                                     ? RowBufPolicy::SMART_CLOSE
+                                     : RowBufPolicy::OPEN_PAGE;
+    // drop timers armed by the previous policy
+    timeout_ticking[queue_idx] = false;
+}
+
+// ===== Functional Warmup =====
+
+bool CommandQueue::WarmTimeout(int queue_idx, int open_row,
+                               uint64_t idle_cycles) {
+    auto policy = bank_policy_[queue_idx];
+    if (policy != RowBufPolicy::GS && policy != RowBufPolicy::GS_NOHOTROW &&
+        policy != RowBufPolicy::STATIC_TIMEOUT) {
+        return false;
+    }
+    if (idle_cycles < static_cast<uint64_t>(GetCurrentTimeout(queue_idx))) {
+        return false;
+    }
+    if (policy == RowBufPolicy::STATIC_TIMEOUT) {
+        return true;
+    }
+    // same bookkeeping as the timeout precharge in Controller::ClockTick
+    auto& detect = re_detect_state_[queue_idx];
+    if (policy == RowBufPolicy::GS) {
+        int rank, bankgroup, bank;
+        GetBankFromIndex(queue_idx, rank, bankgroup, bank);
+        if (RE_IsInStore(rank, bankgroup, bank, open_row)) {
+            return false;
+        }
+        detect.prev_closed_by_timeout = true;
+        detect.prev_row = open_row;
+    }
+    detect.pending_timeout_check = true;
+    detect.timeout_closed_row = open_row;
+    return true;
+}
+
+void CommandQueue::WarmActivate(int queue_idx, int row, uint64_t clk) {
+    auto policy = bank_policy_[queue_idx];
+    if (policy == RowBufPolicy::GS || policy == RowBufPolicy::GS_NOHOTROW) {
+        GS_ProcessACT(queue_idx, row, clk);
+    } else if (policy == RowBufPolicy::DYMPL) {
+        dympl_predictor_->TrainOnACT(queue_idx, row);
+        dympl_predictor_->UpdateOnACT(queue_idx, row);
+    } else if (policy == RowBufPolicy::RL_PAGE) {
+        rl_page_agent_->OnActivate(queue_idx, row);
+    }
+}
+
+bool CommandQueue::WarmAccess(int queue_idx, const Command& cmd, bool row_hit,
+                              uint64_t clk) {
+    auto policy = bank_policy_[queue_idx];
+    if (row_hit) {
+        true_row_hit_count_[queue_idx]++;
+        demand_row_hit_count_[queue_idx]++;
+    }
+    total_command_count_[queue_idx]++;
+    if (policy == RowBufPolicy::GS || policy == RowBufPolicy::GS_NOHOTROW) {
+        GS_ProcessCAS(queue_idx, clk);
+    } else if (policy == RowBufPolicy::DYMPL) {
+        dympl_predictor_->UpdateOnCAS(queue_idx, cmd.Row(), cmd.Column(),
+                                      row_hit);
+    } else if (policy == RowBufPolicy::FAPS) {
+        FAPS_TrackAccess(queue_idx, cmd.Row());
+        FAPS_ArbitratePagePolicy();
+    }
+
+    // GS arbitration once per period of functional time
+    if (PolicyActive(RowBufPolicy::GS) ||
+        PolicyActive(RowBufPolicy::GS_NOHOTROW)) {
+        if (top_row_buf_policy_ == RowBufPolicy::GS_ALIGNED ||
+            clk / GS_ARBITRATION_PERIOD > gs_warm_clk_ / GS_ARBITRATION_PERIOD) {
+            GS_SelectTimeouts();
+        }
+    }
+    gs_warm_clk_ = clk;
+
+    // with no queued requests every access ends its row hit cluster
+    if (row_buf_policy_[queue_idx] == RowBufPolicy::SMART_CLOSE ||
+        row_buf_policy_[queue_idx] == RowBufPolicy::CLOSE_PAGE) {
+        return true;
+    } else if (policy == RowBufPolicy::DYMPL) {
+        return !dympl_predictor_->Predict(queue_idx, cmd.Row(), cmd.Column(),
+                                          RowHotness(cmd));
+    } else if (policy == RowBufPolicy::RL_PAGE) {
+        int rh = channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(),
+                                            cmd.Bank());
+        return rl_page_agent_->Decide(queue_idx, cmd.Row(), 0, 0, 0, rh, 1) == 0;
+    }
+    return false;
+}
+
+void CommandQueue::OnReadDone(int rank, int bankgroup, int bank,
+                              uint64_t latency) {
+    int c = duel_leader_of_[GetQueueIndex(rank, bankgroup, bank)];
+    if (c < 0) {
+        return;
+    }
+    duel_reads_[c]++;
+    duel_latency_[c] += latency;
+    simple_stats_.IncrementVec("duel_leader_reads", c);
+    simple_stats_.IncrementVecBy("duel_leader_latency", c, latency);
+}
+
+void CommandQueue::DUEL_ArbitratePolicy() {
+    // candidates are scored by the average read latency of their leaders
+    int best = -1;
+    double best_latency = 0.0;
+    for (size_t c = 0; c < duel_reads_.size(); c++) {
+        if (duel_reads_[c] == 0) {
+            continue;
+        }
+        double avg = static_cast<double>(duel_latency_[c]) / duel_reads_[c];
+        if (best < 0 || avg < best_latency) {
+            best = static_cast<int>(c);
+            best_latency = avg;
+        }
+    }
+    if (best >= 0 && best != duel_winner_) {
+        // stay with the current winner unless it is clearly beaten
+        bool switch_policy = duel_reads_[duel_winner_] == 0;
+        if (!switch_policy) {
+            double winner_latency =
+                static_cast<double>(duel_latency_[duel_winner_]) /
+                duel_reads_[duel_winner_];
+            switch_policy =
+                best_latency < winner_latency * (1.0 - DUEL_SWITCH_MARGIN);
+        }
+        if (switch_policy) {
+            duel_winner_ = best;
+            for (int q = 0; q < num_queues_; q++) {
+                if (duel_leader_of_[q] < 0) {
+                    DUEL_SetBankPolicy(q, config_.duel_policies[best]);
+                }
+            }
+            simple_stats_.Increment("duel_switches");
+        }
+    }
+    simple_stats_.IncrementVec("duel_epochs_won", duel_winner_);
+    std::fill(duel_reads_.begin(), duel_reads_.end(), 0);
+    std::fill(duel_latency_.begin(), duel_latency_.end(), 0);
+}
+
+void CommandQueue::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(rank_q_empty);
+    ckpt.Field(victim_cmds_);
+    ckpt.Field(true_row_hit_count_);
+    ckpt.Field(demand_row_hit_count_);
+    ckpt.Field(total_command_count_);
+    ckpt.Field(issued_cmd);
+    ckpt.Field(queues_);
+    ckpt.Field(ref_q_indices_);
+    ckpt.Field(is_in_ref_);
+    ckpt.Field(queue_idx_);
+    ckpt.Field(clk_);
+    ckpt.Field(warm_cycles_);
+    ckpt.Field(last_cas_rank_);
+    ckpt.Field(last_cas_bankgroup_);
+    ckpt.Field(row_hit_cap_);
+    ckpt.Field(cap_conflicts_);
+    ckpt.Field(cap_cas_);
+
+    std::string policy_key = config_.row_buf_policy;
+    if (top_row_buf_policy_ == RowBufPolicy::DUEL) {
+        for (auto policy : config_.duel_policies) {
+            policy_key += "," + std::to_string(static_cast<int>(policy));
+        }
+    }
+    ckpt.Block(policy_key, [&] {
+        ckpt.Field(row_buf_policy_);
+        ckpt.Field(bank_policy_);
+        ckpt.Field(bank_sm);
+        ckpt.Field(timeout_counter);
+        ckpt.Field(timeout_ticking);
+        ckpt.Field(gs_shadow_state_);
+        ckpt.Field(gs_aligned_req_count_);
+        ckpt.Field(gs_warm_clk_);
+        ckpt.Field(static_timeout_open_row_);
+        ckpt.Field(row_exclusion_store_);
+        ckpt.Field(re_detect_state_);
+        ckpt.Field(faps_bank_state_);
+        ckpt.Field(duel_leader_of_);
+        ckpt.Field(duel_winner_);
+        ckpt.Field(duel_reads_);
+        ckpt.Field(duel_latency_);
+        if (dympl_predictor_) {
+            dympl_predictor_->Serialize(ckpt);
+        }
+        if (rl_page_agent_) {
+            rl_page_agent_->Serialize(ckpt);
+        }
+    });
+    ckpt.Block(cmd_scheduler_ ? config_.cmd_scheduler : "",
+               [&] { cmd_scheduler_->Serialize(ckpt); });
+}
+
 }  // namespace dramsim3
@@ -7,6 +7,7 @@
 #include <deque>
 #include "channel_state.h"
 #include "common.h"
+#include "command_scheduler.h"
 #include "configuration.h"
 #include "dympl_predictor.h"
 #include "rl_page_agent.h"
@@ -21,12 +22,16 @@ static constexpr int GS_VARIATION_THRESHOLD = 5;
 static constexpr int GS_ALIGNED_VARIATION_THRESHOLD = 3;  // Paper Table 2: 3%
 static constexpr int GS_ALIGNED_ARBITRATION_REQUESTS = 30000;  // Paper Table 2: 30000 requests
 
-// ===== FAPS-3D Constants =====
-static constexpr int FAPS_EPOCH_ACCESSES = 1000;
+// ===== Row Hit Cap Constants =====
+static constexpr uint64_t ROW_HIT_CAP_EPOCH = 1000;  // adaptation period (cycles)
+static constexpr int ROW_HIT_CAP_RARE_CONFLICT_RATIO = 8;  // grow if conflicts < CAS/8
 
 // ===== FAPS-3D Constants =====
 static constexpr int FAPS_EPOCH_ACCESSES = 1000;
 
+// ===== DUEL Constants =====
+static constexpr double DUEL_SWITCH_MARGIN = 0.05;  // relative latency gain to switch
+
 // Per bank shadow simulation state for timeout update
 struct GSShadowState {
     int curr_timeout_idx = 1;  // Default 100 cycles (index 1)
@@ -84,11 +89,18 @@ class CommandQueue {
     void ArbitratePagePolicy();
     void ClockTick();
     bool WillAcceptCommand(int rank, int bankgroup, int bank) const;
+    // row < 0 matches any row of the bank
+    bool HasRowInQueue(int rank, int bankgroup, int bank, int row) const;
+    // a demand read merged into a queued prefetch read
+    void UpgradePrefetch(int rank, int bankgroup, int bank, uint64_t hex_addr);
     bool AddCommand(Command cmd);
     bool QueueEmpty() const;
     int QueueUsage() const;
     int GetTotalQueueCapacity() const;
     bool IsQueueFull() const;
+    // queues and page policy state, the latter only restored under the
+    // same row_buf_policy
+    void Serialize(Checkpoint& ckpt);
     std::vector<bool> rank_q_empty;
     std::vector<CMDQueue> victim_cmds_;
     //row hit r/w command count issued in every schedule interval, including those targeting victim commands
@@ -100,12 +112,39 @@ class CommandQueue {
     //reserve for dpm 
     std::vector<RowBufPolicy> row_buf_policy_;
     RowBufPolicy top_row_buf_policy_;
+    // page policy each bank runs, only differs from the top policy in DUEL
+    std::vector<RowBufPolicy> bank_policy_;
+    // true if any bank may run this policy
+    bool PolicyActive(RowBufPolicy policy) const;
+    // read latency feedback for the DUEL leaders
+    void OnReadDone(int rank, int bankgroup, int bank, uint64_t latency);
+    // functional warmup, policy learning for accesses the controller applies
+    // to the bank states without timing. True if a timeout policy would have
+    // closed open_row after idle_cycles
+    bool WarmTimeout(int queue_idx, int open_row, uint64_t idle_cycles);
+    void WarmActivate(int queue_idx, int row, uint64_t clk);
+    // true if the page policy closes the row after this access
+    bool WarmAccess(int queue_idx, const Command& cmd, bool row_hit,
+                    uint64_t clk);
+    // a warmed span of cycles is over, see warm_cycles_
+    void EndWarmup(uint64_t cycles) { warm_cycles_ += cycles; }
     Controller* controller_;
     bool ArbitratePrecharge(const CMDIterator& cmd_it,
                             const CMDQueue& queue) const;
     bool HasRWDependency(const CMDIterator& cmd_it,
                          const CMDQueue& queue) const;
     Command GetFirstReadyInQueue(CMDQueue& queue) ;
+    // ready command for a queued request if nothing holds it back
+    Command GetIssuableCommand(const CMDIterator& cmd_it, const CMDQueue& queue,
+                               int queue_idx) const;
+    // bookkeeping once a command of queue_idx_ is picked for issue
+    void OnCommandSelected(const CMDIterator& cmd_it, const Command& cmd);
+    Command IssueRWCommand(Command cmd, CMDQueue& queue);
+    Command GetScheduledCommand();
+    Command GetReservedCommand();
+    // queue holding a ready CAS to another bank group of the last CAS rank,
+    // the CAS itself is returned through pick_it/pick
+    int GetInterleavedQueue(CMDIterator& pick_it, Command& pick);
     int GetQueueIndex(int rank, int bankgroup, int bank) const;
     CMDQueue& GetQueue(int rank, int bankgroup, int bank);
     CMDQueue& GetNextQueue();
@@ -132,6 +171,11 @@ class CommandQueue {
     size_t queue_size_;
     int queue_idx_;
     uint64_t clk_;
+    // cycles cut out by functional warmup, the GS shadow state runs on
+    // clk_ + warm_cycles_ so warmed and detailed accesses share a time base
+    uint64_t warm_cycles_;
+    int last_cas_rank_;
+    int last_cas_bankgroup_;
 
     // ===== GS Timeout Update Members =====
     std::vector<GSShadowState> gs_shadow_state_;  // per bank
@@ -141,9 +185,20 @@ class CommandQueue {
     void GS_ProcessACT(int queue_idx, int new_row, uint64_t curr_cycle);
     void GS_ProcessCAS(int queue_idx, uint64_t curr_cycle);
     void GS_ArbitrateTimeout();
+    void GS_SelectTimeouts();
+    uint64_t gs_warm_clk_;  // last functional access or arbitration
     void GetBankFromIndex(int queue_idx, int& rank, int& bankgroup, int& bank) const;
     int GetCurrentTimeout(int queue_idx) const;
 
+    // ===== Row Hit Cap Members =====
+    std::vector<int> row_hit_cap_;        // per queue
+    std::vector<int> cap_conflicts_;      // on-demand PREs in this epoch
+    std::vector<int> cap_cas_;            // CAS commands in this epoch
+    void AdaptRowHitCap();
+    bool IsAged(const Command& cmd) const;
+    bool HasAgedConflictAhead(const CMDIterator& cmd_it,
+                              const CMDQueue& queue) const;
+
     // ===== Static Timeout Members =====
     std::vector<int> static_timeout_open_row_;  // Row number waiting for each queue
 
@@ -168,9 +223,23 @@ class CommandQueue {
 
     // ===== DYMPL Predictor =====
     std::unique_ptr<DYMPLPredictor> dympl_predictor_;
+    // page hotness feature, read from the controller's row tracker
+    uint32_t RowHotness(const Command& cmd) const;
 
     // ===== RL_PAGE Agent =====
     std::unique_ptr<RLPageAgent> rl_page_agent_;
+
+    // ===== DUEL Members =====
+    std::vector<int> duel_leader_of_;  // per queue, candidate it leads or -1
+    int duel_winner_;                  // candidate the followers run
+    std::vector<uint64_t> duel_reads_;    // per candidate, this epoch
+    std::vector<uint64_t> duel_latency_;  // per candidate, this epoch
+    void DUEL_AssignLeaders();
+    void DUEL_ArbitratePolicy();
+    void DUEL_SetBankPolicy(int queue_idx, RowBufPolicy policy);
+
+    // ===== Requestor-aware command scheduler, null for FRFCFS =====
+    std::unique_ptr<CommandScheduler> cmd_scheduler_;
 };
 
 }  // namespace dramsim3
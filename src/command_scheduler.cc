@@ -0,0 +1,548 @@
+#include "command_scheduler.h"
+#include <algorithm>
+#include <numeric>
+
+namespace dramsim3 {
+
+CommandScheduler::CommandScheduler(
+    const Config& config, const std::vector<std::vector<Command>>& queues,
+    SimpleStats& simple_stats)
+    : config_(config),
+      queues_(queues),
+      simple_stats_(simple_stats),
+      num_sources_(config.num_sources) {}
+
+int CommandScheduler::Select(const std::vector<SchedCandidate>& cands,
+                             uint64_t clk) {
+    Prepare(clk);
+    int best = 0;
+    for (size_t i = 1; i < cands.size(); i++) {
+        if (HigherPriority(cands[i], cands[best])) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+bool CommandScheduler::FRFCFSOrder(const SchedCandidate& a,
+                                   const SchedCandidate& b) {
+    if (a.row_hit != b.row_hit) {
+        return a.row_hit;
+    }
+    return a.arrival < b.arrival;
+}
+
+int CommandScheduler::Source(int source_id) const {
+    if (source_id < 0 || source_id >= num_sources_) {
+        return num_sources_ - 1;
+    }
+    return source_id;
+}
+
+// ===== PAR-BS =====
+
+PARBSScheduler::PARBSScheduler(const Config& config,
+                               const std::vector<std::vector<Command>>& queues,
+                               SimpleStats& simple_stats)
+    : CommandScheduler(config, queues, simple_stats),
+      cutoff_(num_sources_, std::vector<uint64_t>(queues.size(), 0)),
+      has_cutoff_(num_sources_, std::vector<char>(queues.size(), false)),
+      rank_(num_sources_, 0) {}
+
+bool PARBSScheduler::IsMarked(int queue_idx, const Command& cmd) const {
+    int s = Source(cmd.source_id);
+    return has_cutoff_[s][queue_idx] && cmd.added_cycle <= cutoff_[s][queue_idx];
+}
+
+void PARBSScheduler::Prepare(uint64_t clk) {
+    bool queues_empty = true;
+    for (size_t q = 0; q < queues_.size(); q++) {
+        for (const auto& cmd : queues_[q]) {
+            if (IsMarked(q, cmd)) {
+                return;  // current batch not done yet
+            }
+            queues_empty = false;
+        }
+    }
+    if (!queues_empty) {
+        FormBatch();
+    }
+}
+
+void PARBSScheduler::FormBatch() {
+    std::vector<int> max_load(num_sources_, 0);
+    std::vector<int> total_load(num_sources_, 0);
+    std::vector<std::vector<uint64_t>> arrivals(num_sources_);
+    for (size_t q = 0; q < queues_.size(); q++) {
+        for (auto& a : arrivals) {
+            a.clear();
+        }
+        for (const auto& cmd : queues_[q]) {
+            arrivals[Source(cmd.source_id)].push_back(cmd.added_cycle);
+        }
+        for (int s = 0; s < num_sources_; s++) {
+            has_cutoff_[s][q] = !arrivals[s].empty();
+            if (arrivals[s].empty()) {
+                continue;
+            }
+            int marked = std::min(static_cast<int>(arrivals[s].size()),
+                                  config_.parbs_marking_cap);
+            std::nth_element(arrivals[s].begin(),
+                             arrivals[s].begin() + marked - 1,
+                             arrivals[s].end());
+            cutoff_[s][q] = arrivals[s][marked - 1];
+            max_load[s] = std::max(max_load[s], marked);
+            total_load[s] += marked;
+        }
+    }
+
+    // shortest job first: lowest max bank load, then lowest total load
+    std::vector<int> order(num_sources_);
+    for (int s = 0; s < num_sources_; s++) {
+        order[s] = s;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (max_load[a] != max_load[b]) {
+            return max_load[a] < max_load[b];
+        }
+        return total_load[a] < total_load[b];
+    });
+    for (int i = 0; i < num_sources_; i++) {
+        rank_[order[i]] = i;
+    }
+    simple_stats_.Increment("parbs_batches");
+}
+
+bool PARBSScheduler::HigherPriority(const SchedCandidate& a,
+                                    const SchedCandidate& b) const {
+    bool a_marked = IsMarked(a.queue_idx, queues_[a.queue_idx][a.cmd_idx]);
+    bool b_marked = IsMarked(b.queue_idx, queues_[b.queue_idx][b.cmd_idx]);
+    if (a_marked != b_marked) {
+        return a_marked;
+    }
+    if (a.row_hit != b.row_hit) {
+        return a.row_hit;
+    }
+    int a_rank = rank_[Source(a.source_id)];
+    int b_rank = rank_[Source(b.source_id)];
+    if (a_rank != b_rank) {
+        return a_rank < b_rank;
+    }
+    return a.arrival < b.arrival;
+}
+
+void PARBSScheduler::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(cutoff_);
+    ckpt.Field(has_cutoff_);
+    ckpt.Field(rank_);
+}
+
+// ===== TCM =====
+
+TCMScheduler::TCMScheduler(const Config& config,
+                           const std::vector<std::vector<Command>>& queues,
+                           SimpleStats& simple_stats)
+    : CommandScheduler(config, queues, simple_stats),
+      quantum_start_(0),
+      last_shuffle_(0),
+      served_(num_sources_, 0),
+      acts_(num_sources_, 0),
+      blp_sum_(num_sources_, 0),
+      blp_samples_(0),
+      latency_cluster_size_(0),
+      rank_(num_sources_, 0) {}
+
+void TCMScheduler::OnIssue(const SchedCandidate& cand) {
+    int s = Source(cand.source_id);
+    if (cand.cmd.IsReadWrite()) {
+        served_[s]++;
+    } else if (cand.cmd.cmd_type == CommandType::ACTIVATE) {
+        acts_[s]++;
+    }
+}
+
+void TCMScheduler::Prepare(uint64_t clk) {
+    // sample bank level parallelism: banks with outstanding requests
+    std::vector<uint64_t> banks(num_sources_, 0);
+    std::vector<char> seen(num_sources_);
+    for (const auto& queue : queues_) {
+        std::fill(seen.begin(), seen.end(), false);
+        for (const auto& cmd : queue) {
+            int s = Source(cmd.source_id);
+            if (!seen[s]) {
+                seen[s] = true;
+                banks[s]++;
+            }
+        }
+    }
+    for (int s = 0; s < num_sources_; s++) {
+        blp_sum_[s] += banks[s];
+    }
+    blp_samples_++;
+
+    if (clk - quantum_start_ >= static_cast<uint64_t>(config_.tcm_quantum)) {
+        Recluster();
+        quantum_start_ = clk;
+        last_shuffle_ = clk;
+    } else if (clk - last_shuffle_ >=
+               static_cast<uint64_t>(config_.tcm_shuffle_interval)) {
+        Shuffle();
+        last_shuffle_ = clk;
+    }
+}
+
+void TCMScheduler::Recluster() {
+    uint64_t total = 0;
+    std::vector<int> order(num_sources_);
+    for (int s = 0; s < num_sources_; s++) {
+        order[s] = s;
+        total += served_[s];
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return served_[a] < served_[b]; });
+
+    // lightest sources go to the latency cluster until the threshold
+    uint64_t sum = 0;
+    latency_cluster_size_ = 0;
+    for (int s : order) {
+        sum += served_[s];
+        if (sum > config_.tcm_cluster_threshold * total) {
+            break;
+        }
+        rank_[s] = latency_cluster_size_++;
+        simple_stats_.IncrementVec("tcm_latency_cluster", s);
+    }
+    bw_cluster_.assign(order.begin() + latency_cluster_size_, order.end());
+
+    // niceness = BLP rank - RBL rank, high BLP sources suffer most from
+    // interference and high RBL sources cause the most of it
+    std::vector<double> blp(num_sources_, 0.0);
+    std::vector<double> rbl(num_sources_, 0.0);
+    for (int s : bw_cluster_) {
+        blp[s] = blp_samples_ > 0
+                     ? static_cast<double>(blp_sum_[s]) / blp_samples_
+                     : 0.0;
+        rbl[s] = served_[s] > acts_[s]
+                     ? 1.0 - static_cast<double>(acts_[s]) / served_[s]
+                     : 0.0;
+    }
+    std::vector<int> by_blp(bw_cluster_), by_rbl(bw_cluster_);
+    std::stable_sort(by_blp.begin(), by_blp.end(),
+                     [&](int a, int b) { return blp[a] < blp[b]; });
+    std::stable_sort(by_rbl.begin(), by_rbl.end(),
+                     [&](int a, int b) { return rbl[a] < rbl[b]; });
+    std::vector<int> niceness(num_sources_, 0);
+    for (size_t i = 0; i < by_blp.size(); i++) {
+        niceness[by_blp[i]] += static_cast<int>(i);
+        niceness[by_rbl[i]] -= static_cast<int>(i);
+    }
+    std::stable_sort(bw_cluster_.begin(), bw_cluster_.end(),
+                     [&](int a, int b) { return niceness[a] > niceness[b]; });
+    for (size_t i = 0; i < bw_cluster_.size(); i++) {
+        rank_[bw_cluster_[i]] = latency_cluster_size_ + static_cast<int>(i);
+    }
+
+    std::fill(served_.begin(), served_.end(), 0);
+    std::fill(acts_.begin(), acts_.end(), 0);
+    std::fill(blp_sum_.begin(), blp_sum_.end(), 0);
+    blp_samples_ = 0;
+    simple_stats_.Increment("tcm_quanta");
+}
+
+void TCMScheduler::Shuffle() {
+    if (bw_cluster_.size() < 2) {
+        return;
+    }
+    // rotate the niceness order so no bandwidth source starves
+    std::rotate(bw_cluster_.begin(), bw_cluster_.begin() + 1,
+                bw_cluster_.end());
+    for (size_t i = 0; i < bw_cluster_.size(); i++) {
+        rank_[bw_cluster_[i]] = latency_cluster_size_ + static_cast<int>(i);
+    }
+    simple_stats_.Increment("tcm_shuffles");
+}
+
+bool TCMScheduler::HigherPriority(const SchedCandidate& a,
+                                  const SchedCandidate& b) const {
+    int a_rank = rank_[Source(a.source_id)];
+    int b_rank = rank_[Source(b.source_id)];
+    if (a_rank != b_rank) {
+        return a_rank < b_rank;
+    }
+    return FRFCFSOrder(a, b);
+}
+
+void TCMScheduler::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(quantum_start_);
+    ckpt.Field(last_shuffle_);
+    ckpt.Field(served_);
+    ckpt.Field(acts_);
+    ckpt.Field(blp_sum_);
+    ckpt.Field(blp_samples_);
+    ckpt.Field(bw_cluster_);
+    ckpt.Field(latency_cluster_size_);
+    ckpt.Field(rank_);
+}
+
+// ===== BLISS =====
+
+BLISSScheduler::BLISSScheduler(const Config& config,
+                               const std::vector<std::vector<Command>>& queues,
+                               SimpleStats& simple_stats)
+    : CommandScheduler(config, queues, simple_stats),
+      blacklisted_(num_sources_, false),
+      last_source_(-1),
+      streak_(0),
+      last_clear_(0) {}
+
+void BLISSScheduler::OnIssue(const SchedCandidate& cand) {
+    if (!cand.cmd.IsReadWrite()) {
+        return;
+    }
+    int s = Source(cand.source_id);
+    if (s == last_source_) {
+        streak_++;
+    } else {
+        last_source_ = s;
+        streak_ = 1;
+    }
+    if (streak_ >= config_.bliss_threshold && !blacklisted_[s]) {
+        blacklisted_[s] = true;
+        simple_stats_.Increment("bliss_blacklistings");
+    }
+}
+
+void BLISSScheduler::Prepare(uint64_t clk) {
+    if (clk - last_clear_ >= static_cast<uint64_t>(config_.bliss_clear_interval)) {
+        std::fill(blacklisted_.begin(), blacklisted_.end(), false);
+        last_clear_ = clk;
+    }
+}
+
+bool BLISSScheduler::HigherPriority(const SchedCandidate& a,
+                                    const SchedCandidate& b) const {
+    bool a_black = blacklisted_[Source(a.source_id)];
+    bool b_black = blacklisted_[Source(b.source_id)];
+    if (a_black != b_black) {
+        return !a_black;
+    }
+    return FRFCFSOrder(a, b);
+}
+
+void BLISSScheduler::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(blacklisted_);
+    ckpt.Field(last_source_);
+    ckpt.Field(streak_);
+    ckpt.Field(last_clear_);
+}
+
+// ===== QoS =====
+
+QoSScheduler::QoSScheduler(const Config& config,
+                           const std::vector<std::vector<Command>>& queues,
+                           SimpleStats& simple_stats)
+    : CommandScheduler(config, queues, simple_stats), arbiter_(config) {}
+
+void QoSScheduler::OnIssue(const SchedCandidate& cand) {
+    if (cand.cmd.IsReadWrite()) {
+        arbiter_.OnServed(cand.qos_class);
+    }
+}
+
+bool QoSScheduler::HigherPriority(const SchedCandidate& a,
+                                  const SchedCandidate& b) const {
+    if (!arbiter_.Tie(a.qos_class, a.deadline, b.qos_class, b.deadline)) {
+        return arbiter_.Before(a.qos_class, a.deadline, b.qos_class,
+                               b.deadline);
+    }
+    return FRFCFSOrder(a, b);
+}
+
+void QoSScheduler::Serialize(Checkpoint& ckpt) { arbiter_.Serialize(ckpt); }
+
+// ===== RL =====
+
+RLScheduler::RLScheduler(const Config& config,
+                         const std::vector<std::vector<Command>>& queues,
+                         SimpleStats& simple_stats)
+    : CommandScheduler(config, queues, simple_stats),
+      rng_(42),
+      queued_reads_(0),
+      queued_writes_(0),
+      has_prev_(false),
+      prev_reward_(0) {
+    for (int t = 0; t < RLSCHED_NUM_TILINGS; t++) {
+        for (int i = 0; i < RLSCHED_TABLE_SIZE; i++) {
+            cmac_[t][i] = RLSCHED_INIT_Q_PER_TILING;
+        }
+    }
+}
+
+void RLScheduler::Prepare(uint64_t clk) {
+    queued_reads_ = 0;
+    queued_writes_ = 0;
+    for (const auto& queue : queues_) {
+        for (const auto& cmd : queue) {
+            if (cmd.IsWrite()) {
+                queued_writes_++;
+            } else {
+                queued_reads_++;
+            }
+        }
+    }
+}
+
+bool RLScheduler::HigherPriority(const SchedCandidate& a,
+                                 const SchedCandidate& b) const {
+    return FRFCFSOrder(a, b);
+}
+
+RLSchedState RLScheduler::MakeState(const SchedCandidate& cand,
+                                    uint64_t clk) const {
+    const auto& queue = queues_[cand.queue_idx];
+    const auto& req = queue[cand.cmd_idx];
+    int same_row = 0;
+    for (const auto& cmd : queue) {
+        if (cmd.Bank() == req.Bank() && cmd.Bankgroup() == req.Bankgroup() &&
+            cmd.Rank() == req.Rank() && cmd.Row() == req.Row()) {
+            same_row++;
+        }
+    }
+    RLSchedState s;
+    s.reads = std::min(queued_reads_ >> 2, 15);
+    s.writes = std::min(queued_writes_ >> 2, 15);
+    s.bank_q = std::min(static_cast<int>(queue.size()), 7);
+    s.same_row = std::min(same_row, 7);
+    s.age = static_cast<int>(std::min<uint64_t>((clk - cand.arrival) >> 6, 7));
+    s.oldest = cand.cmd_idx == 0 ? 1 : 0;
+    switch (cand.cmd.cmd_type) {
+        case CommandType::ACTIVATE:
+            s.action = 0;
+            break;
+        case CommandType::PRECHARGE:
+            s.action = 1;
+            break;
+        case CommandType::READ:
+        case CommandType::READ_PRECHARGE:
+            s.action = 2;
+            break;
+        default:
+            s.action = 3;
+            break;
+    }
+    return s;
+}
+
+int RLScheduler::CMACIndex(int tiling, const RLSchedState& s) const {
+    // each tiling shifts every feature by a different offset before packing
+    uint32_t raw = (((s.reads + tiling * 3) & 0xF) << 16) |
+                   (((s.writes + tiling * 5) & 0xF) << 12) |
+                   (((s.bank_q + tiling * 7) & 0x7) << 9) |
+                   (((s.same_row + tiling * 3) & 0x7) << 6) |
+                   (((s.age + tiling * 5) & 0x7) << 3) | (s.oldest << 2) |
+                   s.action;
+    raw = (raw + tiling) * 2654435761u;
+    return static_cast<int>(raw >> (32 - RLSCHED_TABLE_BITS));
+}
+
+int32_t RLScheduler::GetQ(const RLSchedState& s) const {
+    int32_t sum = 0;
+    for (int t = 0; t < RLSCHED_NUM_TILINGS; t++) {
+        sum += cmac_[t][CMACIndex(t, s)];
+    }
+    return sum;
+}
+
+void RLScheduler::UpdateQ(const RLSchedState& s, int32_t td_error) {
+    int32_t delta =
+        static_cast<int32_t>(RLSCHED_ALPHA * td_error / RLSCHED_NUM_TILINGS);
+    for (int t = 0; t < RLSCHED_NUM_TILINGS; t++) {
+        int idx = CMACIndex(t, s);
+        int32_t val = std::max(-32768, std::min(32767, cmac_[t][idx] + delta));
+        cmac_[t][idx] = static_cast<int16_t>(val);
+    }
+}
+
+int RLScheduler::Select(const std::vector<SchedCandidate>& cands,
+                        uint64_t clk) {
+    Prepare(clk);
+    simple_stats_.Increment("rl_sched_decisions");
+
+    // decision budget, only the best candidates by FR-FCFS get evaluated
+    std::vector<int> idx(cands.size());
+    std::iota(idx.begin(), idx.end(), 0);
+    size_t budget = static_cast<size_t>(config_.rl_sched_budget);
+    if (idx.size() > budget) {
+        std::nth_element(idx.begin(), idx.begin() + budget - 1, idx.end(),
+                         [&](int a, int b) {
+                             return FRFCFSOrder(cands[a], cands[b]);
+                         });
+        idx.resize(budget);
+        simple_stats_.Increment("rl_sched_budget_cuts");
+    }
+
+    int best = idx[0];
+    RLSchedState best_state = MakeState(cands[best], clk);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    if (dist(rng_) < RLSCHED_EPSILON) {
+        std::uniform_int_distribution<size_t> pick(0, idx.size() - 1);
+        best = idx[pick(rng_)];
+        best_state = MakeState(cands[best], clk);
+        simple_stats_.Increment("rl_sched_explorations");
+    } else {
+        int32_t best_q = GetQ(best_state);
+        for (size_t i = 1; i < idx.size(); i++) {
+            const auto& cand = cands[idx[i]];
+            RLSchedState s = MakeState(cand, clk);
+            int32_t q = GetQ(s);
+            if (q > best_q ||
+                (q == best_q && FRFCFSOrder(cand, cands[best]))) {
+                best = idx[i];
+                best_q = q;
+                best_state = s;
+            }
+        }
+    }
+
+    // starvation guard, the oldest request past max_request_age goes first
+    if (config_.max_request_age > 0) {
+        int oldest = best;
+        for (size_t i = 0; i < cands.size(); i++) {
+            if (cands[i].arrival < cands[oldest].arrival) {
+                oldest = static_cast<int>(i);
+            }
+        }
+        if (oldest != best &&
+            clk - cands[oldest].arrival >
+                static_cast<uint64_t>(config_.max_request_age)) {
+            best = oldest;
+            best_state = MakeState(cands[best], clk);
+            simple_stats_.Increment("rl_sched_starvation_picks");
+        }
+    }
+
+    // SARSA: r + gamma * Q(s', a') - Q(s, a) for the previous decision
+    if (has_prev_) {
+        int32_t td_error =
+            prev_reward_ * 1024 +
+            static_cast<int32_t>(RLSCHED_GAMMA * GetQ(best_state)) -
+            GetQ(prev_state_);
+        UpdateQ(prev_state_, td_error);
+    }
+    has_prev_ = true;
+    prev_state_ = best_state;
+    prev_reward_ = cands[best].cmd.IsReadWrite() ? 1 : 0;
+    return best;
+}
+
+void RLScheduler::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(rng_);
+    ckpt.Field(cmac_);
+    ckpt.Field(queued_reads_);
+    ckpt.Field(queued_writes_);
+    ckpt.Field(has_prev_);
+    ckpt.Field(prev_state_);
+    ckpt.Field(prev_reward_);
+}
+
+}  // namespace dramsim3
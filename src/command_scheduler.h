@@ -0,0 +1,209 @@
+#ifndef __COMMAND_SCHEDULER_H
+#define __COMMAND_SCHEDULER_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "checkpoint.h"
+#include "common.h"
+#include "configuration.h"
+#include "qos_arbiter.h"
+#include "simple_stats.h"
+
+namespace dramsim3 {
+
+// One issuable command, as seen by the global command pick
+struct SchedCandidate {
+    int queue_idx;      // command queue it lives in
+    int cmd_idx;        // position inside that queue
+    Command cmd;        // ready command (ACT/PRE/RD/WR) for the request
+    int source_id;      // requestor of the queued request
+    uint64_t arrival;   // cycle the request entered the controller
+    bool row_hit;       // ready command is a column command
+    int qos_class;      // QoS class of the queued request
+    uint64_t deadline;  // absolute deadline, 0 if none
+};
+
+// Requestor-aware command scheduler, looks at every issuable command of the
+// channel at once instead of the per-queue round robin. FR-FCFS is kept as
+// the legacy path in CommandQueue and has no scheduler object.
+class CommandScheduler {
+   public:
+    CommandScheduler(const Config& config,
+                     const std::vector<std::vector<Command>>& queues,
+                     SimpleStats& simple_stats);
+    virtual ~CommandScheduler() {}
+    // returns index of the candidate to issue, cands must not be empty
+    virtual int Select(const std::vector<SchedCandidate>& cands, uint64_t clk);
+    // called once the selected candidate is issued
+    virtual void OnIssue(const SchedCandidate& cand) {}
+    // learned or batched state, none for the stateless schedulers
+    virtual void Serialize(Checkpoint& ckpt) {}
+
+   protected:
+    // refresh per-cycle state (batches, clusters, blacklists)
+    virtual void Prepare(uint64_t clk) {}
+    // true if a should be issued before b
+    virtual bool HigherPriority(const SchedCandidate& a,
+                                const SchedCandidate& b) const = 0;
+    static bool FRFCFSOrder(const SchedCandidate& a, const SchedCandidate& b);
+    int Source(int source_id) const;
+
+    const Config& config_;
+    const std::vector<std::vector<Command>>& queues_;
+    SimpleStats& simple_stats_;
+    int num_sources_;
+};
+
+// PAR-BS: the oldest requests of each source per bank are marked into a
+// batch, marked requests go first and within a batch sources with the
+// smallest max-bank load (shortest job) are ranked highest
+class PARBSScheduler : public CommandScheduler {
+   public:
+    PARBSScheduler(const Config& config,
+                   const std::vector<std::vector<Command>>& queues,
+                   SimpleStats& simple_stats);
+    void Serialize(Checkpoint& ckpt) override;
+
+   protected:
+    void Prepare(uint64_t clk) override;
+    bool HigherPriority(const SchedCandidate& a,
+                        const SchedCandidate& b) const override;
+
+   private:
+    bool IsMarked(int queue_idx, const Command& cmd) const;
+    void FormBatch();
+
+    // per source, per queue arrival cutoff, requests at or before are marked
+    std::vector<std::vector<uint64_t>> cutoff_;
+    std::vector<std::vector<char>> has_cutoff_;
+    std::vector<int> rank_;
+};
+
+// TCM: every quantum sources are split by bandwidth usage into a latency
+// sensitive cluster (always prioritized, lightest first) and a bandwidth
+// cluster ordered by niceness and shuffled periodically
+class TCMScheduler : public CommandScheduler {
+   public:
+    TCMScheduler(const Config& config,
+                 const std::vector<std::vector<Command>>& queues,
+                 SimpleStats& simple_stats);
+    void OnIssue(const SchedCandidate& cand) override;
+    void Serialize(Checkpoint& ckpt) override;
+
+   protected:
+    void Prepare(uint64_t clk) override;
+    bool HigherPriority(const SchedCandidate& a,
+                        const SchedCandidate& b) const override;
+
+   private:
+    void Recluster();
+    void Shuffle();
+
+    uint64_t quantum_start_;
+    uint64_t last_shuffle_;
+    std::vector<uint64_t> served_;
+    std::vector<uint64_t> acts_;
+    std::vector<uint64_t> blp_sum_;
+    uint64_t blp_samples_;
+    std::vector<int> bw_cluster_;  // bandwidth cluster, niceness order
+    int latency_cluster_size_;
+    std::vector<int> rank_;
+};
+
+// BLISS: a source served too many times in a row is blacklisted, and
+// blacklisted sources lose to everyone else until the next clearing
+class BLISSScheduler : public CommandScheduler {
+   public:
+    BLISSScheduler(const Config& config,
+                   const std::vector<std::vector<Command>>& queues,
+                   SimpleStats& simple_stats);
+    void OnIssue(const SchedCandidate& cand) override;
+    void Serialize(Checkpoint& ckpt) override;
+
+   protected:
+    void Prepare(uint64_t clk) override;
+    bool HigherPriority(const SchedCandidate& a,
+                        const SchedCandidate& b) const override;
+
+   private:
+    std::vector<char> blacklisted_;
+    int last_source_;
+    int streak_;
+    uint64_t last_clear_;
+};
+
+// QoS: orders commands by the QoS class or deadline of their request
+// (qos_mode), FR-FCFS among equals
+class QoSScheduler : public CommandScheduler {
+   public:
+    QoSScheduler(const Config& config,
+                 const std::vector<std::vector<Command>>& queues,
+                 SimpleStats& simple_stats);
+    void OnIssue(const SchedCandidate& cand) override;
+    void Serialize(Checkpoint& ckpt) override;
+
+   protected:
+    bool HigherPriority(const SchedCandidate& a,
+                        const SchedCandidate& b) const override;
+
+   private:
+    QoSArbiter arbiter_;
+};
+
+static constexpr int RLSCHED_NUM_TILINGS = 8;
+static constexpr int RLSCHED_TABLE_BITS = 10;
+static constexpr int RLSCHED_TABLE_SIZE = 1 << RLSCHED_TABLE_BITS;
+static constexpr double RLSCHED_ALPHA = 0.1;
+static constexpr double RLSCHED_GAMMA = 0.95;
+static constexpr double RLSCHED_EPSILON = 0.05;
+// rewards are scaled by 1024, optimistic Q = 1/(1-gamma) split over tilings
+static constexpr int16_t RLSCHED_INIT_Q_PER_TILING = 2560;
+
+// State of one candidate command, quantized for the CMAC
+struct RLSchedState {
+    int reads;     // queued reads of the channel   [0,15]
+    int writes;    // queued writes of the channel  [0,15]
+    int bank_q;    // requests in its queue         [0,7]
+    int same_row;  // queued requests to its row    [0,7]
+    int age;       // age of its request, /64       [0,7]
+    int oldest;    // its request heads the queue   [0,1]
+    int action;    // ACT, PRE, RD or WR            [0,3]
+};
+
+// RL: self-optimizing scheduler after Ipek et al., a SARSA agent that picks
+// among all issuable commands of the channel by the CMAC estimate of future
+// data bus utilization (reward 1 per issued CAS). Only the first
+// rl_sched_budget candidates in FR-FCFS order are evaluated per decision.
+class RLScheduler : public CommandScheduler {
+   public:
+    RLScheduler(const Config& config,
+                const std::vector<std::vector<Command>>& queues,
+                SimpleStats& simple_stats);
+    int Select(const std::vector<SchedCandidate>& cands,
+               uint64_t clk) override;
+    void Serialize(Checkpoint& ckpt) override;
+
+   protected:
+    void Prepare(uint64_t clk) override;
+    bool HigherPriority(const SchedCandidate& a,
+                        const SchedCandidate& b) const override;
+
+   private:
+    RLSchedState MakeState(const SchedCandidate& cand, uint64_t clk) const;
+    int CMACIndex(int tiling, const RLSchedState& s) const;
+    int32_t GetQ(const RLSchedState& s) const;
+    void UpdateQ(const RLSchedState& s, int32_t td_error);
+
+    std::mt19937 rng_;
+    int16_t cmac_[RLSCHED_NUM_TILINGS][RLSCHED_TABLE_SIZE];
+    int queued_reads_;
+    int queued_writes_;
+    // previous decision, waiting for its SARSA update
+    bool has_prev_;
+    RLSchedState prev_state_;
+    int prev_reward_;
+};
+
+}  // namespace dramsim3
+#endif
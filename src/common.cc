@@ -1,5 +1,6 @@
 #include "common.h"
 #include "fmt/format.h"
+#include <cctype>
 #include <sstream>
 #include <unordered_set>
 #include <sys/stat.h>
@@ -32,12 +33,35 @@ std::ostream& operator<<(std::ostream& os, const Transaction& trans) {
     return os;
 }
 
+// skips blanks on the current line, true if a number follows
+static bool HasNumberColumn(std::istream& is) {
+    while (is.peek() == ' ' || is.peek() == '\t') {
+        is.get();
+    }
+    return std::isdigit(is.peek());
+}
+
 std::istream& operator>>(std::istream& is, Transaction& trans) {
     std::unordered_set<std::string> write_types = {"WRITE", "write", "P_MEM_WR",
                                                    "BOFF"};
     std::string mem_op;
     is >> std::hex >> trans.addr >> mem_op >> std::dec >> trans.added_cycle;
     trans.is_write = write_types.count(mem_op) == 1;
+    trans.is_prefetch = mem_op == "PREFETCH" || mem_op == "prefetch";
+    // optional columns: source id of the requestor, QoS class and deadline
+    // budget in cycles
+    trans.source_id = 0;
+    trans.qos_class = 0;
+    trans.deadline = 0;
+    if (HasNumberColumn(is)) {
+        is >> trans.source_id;
+    }
+    if (HasNumberColumn(is)) {
+        is >> trans.qos_class;
+    }
+    if (HasNumberColumn(is)) {
+        is >> trans.deadline;
+    }
     return is;
 }
 
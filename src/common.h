@@ -3,11 +3,13 @@
 
 #include <stdint.h>
 #include <iostream>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace dramsim3 {
 
-enum class RowBufPolicy { OPEN_PAGE, CLOSE_PAGE,ORACLE,SMART_CLOSE,DPM,GS,GS_NOHOTROW,DYMPL,FAPS,RL_PAGE,STATIC_TIMEOUT,SIZE };
+enum class RowBufPolicy { OPEN_PAGE, CLOSE_PAGE,ORACLE,SMART_CLOSE,DPM,GS,GS_NOHOTROW,DYMPL,FAPS,RL_PAGE,STATIC_TIMEOUT,DUEL,GS_ALIGNED,SIZE };
 struct Address {
     Address()
         : channel(-1), rank(-1), bankgroup(-1), bank(-1), row(-1), column(-1) {}
@@ -100,6 +102,14 @@ struct Command {
     bool reqd_ACT = false;
     bool induced_precharge = false;
     uint64_t hex_addr;
+    // requestor and arrival cycle of the transaction behind this command
+    int source_id = 0;
+    uint64_t added_cycle = 0;
+    int qos_class = 0;
+    uint64_t deadline = 0;  // absolute cycle, 0 if none
+    bool is_prefetch = false;
+    uint64_t id = 0;
+    uint64_t meta = 0;
 
     int Channel() const { return addr.channel; }
     int Rank() const { return addr.rank; }
@@ -124,17 +134,92 @@ struct Transaction {
         : addr(tran.addr),
           added_cycle(tran.added_cycle),
           complete_cycle(tran.complete_cycle),
-          is_write(tran.is_write) {}
+          is_write(tran.is_write),
+          source_id(tran.source_id),
+          qos_class(tran.qos_class),
+          deadline(tran.deadline),
+          is_prefetch(tran.is_prefetch),
+          id(tran.id),
+          meta(tran.meta) {}
     uint64_t addr;
     uint64_t added_cycle;
     uint64_t complete_cycle;
     uint64_t CRA_idx;
     bool is_ACT;
     bool is_write;
+    int source_id = 0;  // requestor (core/thread), for fairness schedulers
+    int qos_class = 0;  // 0 is the most latency critical
+    uint64_t deadline = 0;  // latency budget on entry, absolute cycle after
+    bool is_prefetch = false;  // cleared once a demand read merges into it
+    uint64_t id = 0;  // caller's request id, handed back on completion
+    uint64_t meta = 0;  // opaque to the simulator, e.g. core id or PC
 
     friend std::ostream& operator<<(std::ostream& os, const Transaction& trans);
     friend std::istream& operator>>(std::istream& is, Transaction& trans);
 };
 
+// a request submitted with MemorySystem::AddRequest or AddTransactions
+struct MemRequest {
+    uint64_t addr;
+    bool is_write;
+    uint64_t id;
+    uint64_t meta;
+    // as for AddTransaction and AddPrefetch, zero when left out of a brace
+    // initializer: source 0, the most critical QoS class, no deadline
+    int source_id;
+    int qos_class;
+    uint64_t deadline;  // latency budget in cycles
+    bool is_prefetch;   // reads only, qos_class and deadline are ignored
+};
+
+// a finished request, passed to the completion callback or collected
+// with MemorySystem::TakeCompletions
+struct MemCompletion {
+    uint64_t addr;
+    uint64_t id;
+    uint64_t meta;
+    bool is_write;
+    bool dropped;  // a prefetch dropped by prefetch_drop_threshold
+};
+
+// statistics of one channel since the start or the last ResetStats
+struct ChannelStatsSnapshot {
+    int channel;
+    std::map<std::string, uint64_t> counters;
+    std::map<std::string, std::vector<uint64_t>> vec_counters;
+    // log-linear histograms as lowest value of a bucket -> count, exact
+    // below 128, buckets are within 1/64 of their value above
+    std::map<std::string, std::map<int, uint64_t>> histograms;
+    double average_bandwidth;     // GB/s
+    double average_read_latency;  // cycles
+    double read_latency_p50;
+    double read_latency_p99;
+    double read_latency_p999;
+    double read_latency_p9999;
+    double row_hit_rate;          // row hits per READ/WRITE command
+    double total_energy;          // pJ
+    double average_power;         // mW
+};
+
+// bumped whenever the snapshot layout or the meaning of a field changes
+static constexpr uint32_t STATS_SNAPSHOT_VERSION = 2;
+
+// in memory stats of the whole system, see MemorySystem::GetStatsSnapshot
+struct StatsSnapshot {
+    uint32_t version;  // STATS_SNAPSHOT_VERSION
+    uint64_t cycle;  // memory cycles simulated
+    std::vector<ChannelStatsSnapshot> channels;
+    // over all channels, bandwidth and power are summed, percentiles come
+    // from the merged histograms
+    double average_bandwidth;
+    double average_read_latency;
+    double read_latency_p50;
+    double read_latency_p99;
+    double read_latency_p999;
+    double read_latency_p9999;
+    double row_hit_rate;
+    double average_power;
+};
+
 }  // namespace dramsim3
 #endif
@@ -1,5 +1,6 @@
 #include "configuration.h"
 
+#include <algorithm>
 #include <vector>
 
 #ifdef THERMAL
@@ -180,6 +181,22 @@ void Config::InitOtherParams() {
     // 1: default value, adds epoch CSV output on level 0
     // 2: adds histogram outputs in a different CSV format
     output_level = reader.GetInteger("other", "output_level", 1);
+    // per channel histogram of cycles between touches of the same row
+    row_hit_distance_stats =
+        reader.GetBoolean("other", "row_hit_distance_stats", false);
+    // SMARTS style sampling: every sample_interval front end cycles run
+    // sample_warmup + sample_window detailed cycles, measure the window and
+    // fast-forward the rest, 0 window disables sampling
+    sample_window = reader.GetInteger("other", "sample_window", 0);
+    sample_warmup = reader.GetInteger("other", "sample_warmup", 2000);
+    sample_interval = reader.GetInteger("other", "sample_interval", 1000000);
+    if (sample_window > 0 &&
+        sample_interval < sample_warmup + sample_window) {
+        std::cerr << "WARNING: sample_interval shorter than sample_warmup + "
+                     "sample_window, sampling every window back to back"
+                  << std::endl;
+        sample_interval = sample_warmup + sample_window;
+    }
     // Other Parameters
     // give a prefix instead of specify the output name one by one...
     // this would allow outputing to a directory and you can always override
@@ -246,6 +263,164 @@ void Config::InitSystemParams() {
     trans_queue_size = GetInteger("system", "trans_queue_size", 32);
     unified_queue = reader.GetBoolean("system", "unified_queue", false);
     write_buf_size = GetInteger("system", "write_buf_size", 16);
+    // how many transactions can move into the command queue per cycle, and
+    // how deep into the transaction queue we look for requests that hit an
+    // open or already queued row (0 keeps the plain FCFS pick)
+    trans_per_cycle = GetInteger("system", "trans_per_cycle", 1);
+    row_hit_first_window = GetInteger("system", "row_hit_first_window", 0);
+    // row hits an open row may serve before a conflicting request can close
+    // it, optionally adapted per bank between min and max: shrunk when the
+    // oldest queued request is older than the age threshold, grown when
+    // conflicts are rare. Requests older than max_request_age (0 = off) may
+    // always close the row
+    row_hit_cap = GetInteger("system", "row_hit_cap", 4);
+    adaptive_row_hit_cap =
+        reader.GetBoolean("system", "adaptive_row_hit_cap", false);
+    row_hit_cap_min = GetInteger("system", "row_hit_cap_min", 1);
+    row_hit_cap_max = GetInteger("system", "row_hit_cap_max", 16);
+    row_hit_cap_age_threshold =
+        GetInteger("system", "row_hit_cap_age_threshold", 500);
+    max_request_age = GetInteger("system", "max_request_age", 0);
+    if (row_hit_cap_min > row_hit_cap_max) {
+        std::cerr << "Warning: row_hit_cap_min above row_hit_cap_max, clamping"
+                  << std::endl;
+        row_hit_cap_min = row_hit_cap_max;
+    }
+    if (row_hit_cap_min < 1) {
+        std::cerr << "Warning: row_hit_cap_min must be >= 1, using 1"
+                  << std::endl;
+        row_hit_cap_min = 1;
+        row_hit_cap_max = std::max(row_hit_cap_max, 1);
+    }
+    // the adaptive cap starts from row_hit_cap and stays within min/max
+    if (adaptive_row_hit_cap &&
+        (row_hit_cap < row_hit_cap_min || row_hit_cap > row_hit_cap_max)) {
+        int clamped =
+            std::min(std::max(row_hit_cap, row_hit_cap_min), row_hit_cap_max);
+        std::cerr << "Warning: row_hit_cap outside [row_hit_cap_min, "
+                     "row_hit_cap_max], using "
+                  << clamped << std::endl;
+        row_hit_cap = clamped;
+    }
+    if (trans_per_cycle < 1) {
+        std::cerr << "Warning: trans_per_cycle must be >= 1, using 1" << std::endl;
+        trans_per_cycle = 1;
+    }
+    // write drain arbiter, watermarks are fractions of the write buffer.
+    // Draining starts at the high watermark (or above the idle watermark when
+    // the command queue is empty) and stops once the buffer is down to the
+    // low watermark
+    write_drain_high_watermark =
+        reader.GetReal("system", "write_drain_high_watermark", 0.875);
+    write_drain_low_watermark =
+        reader.GetReal("system", "write_drain_low_watermark", 0.0);
+    write_drain_idle_watermark =
+        reader.GetReal("system", "write_drain_idle_watermark", 0.5);
+    write_drain_opportunistic =
+        reader.GetBoolean("system", "write_drain_opportunistic", false);
+    write_drain_batch = reader.GetBoolean("system", "write_drain_batch", false);
+    write_drain_per_rank =
+        reader.GetBoolean("system", "write_drain_per_rank", false);
+    if (write_drain_low_watermark > write_drain_high_watermark) {
+        std::cerr << "Warning: write_drain_low_watermark above high watermark,"
+                  << " clamping" << std::endl;
+        write_drain_low_watermark = write_drain_high_watermark;
+    }
+    // prefer a ready CAS to another bank group than the last CAS (tCCD_S)
+    bankgroup_interleave =
+        reader.GetBoolean("system", "bankgroup_interleave", false);
+    // command scheduler, FRFCFS is the per-queue round robin, the others are
+    // requestor aware and use the transaction source ids
+    cmd_scheduler = reader.Get("system", "cmd_scheduler", "FRFCFS");
+    if (cmd_scheduler != "FRFCFS" && cmd_scheduler != "PARBS" &&
+        cmd_scheduler != "TCM" && cmd_scheduler != "BLISS" &&
+        cmd_scheduler != "RL") {
+        std::cerr << "Unknown cmd_scheduler " << cmd_scheduler << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    num_sources = GetInteger("system", "num_sources", 1);
+    if (num_sources < 1) {
+        std::cerr << "Warning: num_sources must be >= 1, using 1" << std::endl;
+        num_sources = 1;
+    }
+    parbs_marking_cap = GetInteger("system", "parbs_marking_cap", 5);
+    tcm_quantum = GetInteger("system", "tcm_quantum", 100000);
+    tcm_cluster_threshold =
+        reader.GetReal("system", "tcm_cluster_threshold", 0.2);
+    tcm_shuffle_interval = GetInteger("system", "tcm_shuffle_interval", 800);
+    bliss_threshold = GetInteger("system", "bliss_threshold", 4);
+    bliss_clear_interval = GetInteger("system", "bliss_clear_interval", 10000);
+    // RL scheduler: max candidates whose value is evaluated per decision,
+    // the rest are cut in FR-FCFS order
+    rl_sched_budget = GetInteger("system", "rl_sched_budget", 16);
+    if (rl_sched_budget < 1) {
+        std::cerr << "Warning: rl_sched_budget must be >= 1, using 1"
+                  << std::endl;
+        rl_sched_budget = 1;
+    }
+    // per source bandwidth limits and reservations, comma separated shares
+    // of the channel peak (0 = none), enforced with token buckets of
+    // bw_bucket_depth requests
+    source_bw_limits.assign(num_sources, 0.0);
+    source_bw_reservations.assign(num_sources, 0.0);
+    auto limits = StringSplit(reader.Get("system", "source_bw_limits", ""), ',');
+    auto reservations =
+        StringSplit(reader.Get("system", "source_bw_reservations", ""), ',');
+    for (int i = 0; i < num_sources; i++) {
+        if (i < static_cast<int>(limits.size())) {
+            source_bw_limits[i] = std::stod(limits[i]);
+        }
+        if (i < static_cast<int>(reservations.size())) {
+            source_bw_reservations[i] = std::stod(reservations[i]);
+        }
+    }
+    bw_bucket_depth = GetInteger("system", "bw_bucket_depth", 8);
+    if (bw_bucket_depth < 1) {
+        std::cerr << "Warning: bw_bucket_depth must be >= 1, using 1"
+                  << std::endl;
+        bw_bucket_depth = 1;
+    }
+    // QoS classes of the extended AddTransaction, class 0 is the most
+    // latency critical, weights are a comma separated list, one per class
+    std::string qos = reader.Get("system", "qos_mode", "NONE");
+    if (qos == "NONE") {
+        qos_mode = QoSMode::NONE;
+    } else if (qos == "STRICT") {
+        qos_mode = QoSMode::STRICT;
+    } else if (qos == "WEIGHTED") {
+        qos_mode = QoSMode::WEIGHTED;
+    } else if (qos == "DEADLINE") {
+        qos_mode = QoSMode::DEADLINE;
+    } else {
+        std::cerr << "Unknown qos_mode " << qos << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    num_qos_classes = GetInteger("system", "num_qos_classes", 1);
+    if (num_qos_classes < 1) {
+        std::cerr << "Warning: num_qos_classes must be >= 1, using 1"
+                  << std::endl;
+        num_qos_classes = 1;
+    }
+    auto weights = StringSplit(reader.Get("system", "qos_weights", ""), ',');
+    qos_weights.assign(num_qos_classes, 1.0);
+    for (int i = 0; i < num_qos_classes && i < static_cast<int>(weights.size());
+         i++) {
+        qos_weights[i] = std::stod(weights[i]);
+        if (qos_weights[i] <= 0.0) {
+            std::cerr << "Warning: qos_weights must be positive, using 1"
+                      << std::endl;
+            qos_weights[i] = 1.0;
+        }
+    }
+    // demand reads go before prefetches (AddPrefetch), prefetches queued
+    // longer than the drop threshold (cycles, 0 = never) are dropped
+    prefetch_aware = reader.GetBoolean("system", "prefetch_aware", false);
+    prefetch_drop_threshold =
+        GetInteger("system", "prefetch_drop_threshold", 0);
+    if (qos_mode != QoSMode::NONE && cmd_scheduler != "FRFCFS") {
+        std::cerr << "Warning: qos_mode only applies to transaction scheduling"
+                  << " with cmd_scheduler " << cmd_scheduler << std::endl;
+    }
     std::string ref_policy =
         reader.Get("system", "refresh_policy", "RANK_LEVEL_STAGGERED");
     if (ref_policy == "RANK_LEVEL_SIMULTANEOUS") {
@@ -263,6 +438,70 @@ void Config::InitSystemParams() {
     sref_threshold = GetInteger("system", "sref_threshold", 1000);
     aggressive_precharging_enabled =
         reader.GetBoolean("system", "aggressive_precharging_enabled", false);
+    // speculative ACT into idle banks, unused rows are closed after timeout
+    speculative_act_enabled =
+        reader.GetBoolean("system", "speculative_act_enabled", false);
+    speculative_act_timeout =
+        GetInteger("system", "speculative_act_timeout", 64);
+    // read the next lines of an open row into a controller side buffer
+    // while the command bus is idle, buffer size in lines
+    row_prefetch_enabled =
+        reader.GetBoolean("system", "row_prefetch_enabled", false);
+    row_prefetch_degree = GetInteger("system", "row_prefetch_degree", 2);
+    row_prefetch_buffer_size =
+        GetInteger("system", "row_prefetch_buffer_size", 16);
+    row_prefetch_hit_latency =
+        GetInteger("system", "row_prefetch_hit_latency", 4);
+    if (row_prefetch_buffer_size < 1) {
+        std::cerr << "Warning: row_prefetch_buffer_size must be >= 1, using 1"
+                  << std::endl;
+        row_prefetch_buffer_size = 1;
+    }
+
+    // DUEL set dueling: each candidate page policy runs on duel_leaders
+    // leader banks, every duel_epoch cycles the followers switch to the
+    // candidate whose leaders had the lowest read latency
+    duel_leaders = GetInteger("system", "duel_leaders", 1);
+    duel_epoch = GetInteger("system", "duel_epoch", 50000);
+    if (duel_leaders < 1) {
+        std::cerr << "Warning: duel_leaders must be >= 1, using 1" << std::endl;
+        duel_leaders = 1;
+    }
+    if (duel_epoch < 1) {
+        std::cerr << "Warning: duel_epoch must be >= 1, using 50000"
+                  << std::endl;
+        duel_epoch = 50000;
+    }
+    auto duel_names = StringSplit(
+        reader.Get("system", "duel_policies",
+                   "OPEN_PAGE,SMART_CLOSE,GS,DYMPL,FAPS,RL_PAGE"),
+        ',');
+    duel_policies.clear();
+    for (const auto& name : duel_names) {
+        if (name == "OPEN_PAGE") {
+            duel_policies.push_back(RowBufPolicy::OPEN_PAGE);
+        } else if (name == "SMART_CLOSE") {
+            duel_policies.push_back(RowBufPolicy::SMART_CLOSE);
+        } else if (name == "GS") {
+            duel_policies.push_back(RowBufPolicy::GS);
+        } else if (name == "GS_NOHOTROW") {
+            duel_policies.push_back(RowBufPolicy::GS_NOHOTROW);
+        } else if (name == "DYMPL") {
+            duel_policies.push_back(RowBufPolicy::DYMPL);
+        } else if (name == "FAPS") {
+            duel_policies.push_back(RowBufPolicy::FAPS);
+        } else if (name == "RL_PAGE") {
+            duel_policies.push_back(RowBufPolicy::RL_PAGE);
+        } else {
+            std::cerr << "Unsupported duel_policies entry " << name
+                      << std::endl;
+            AbruptExit(__FILE__, __LINE__);
+        }
+    }
+    if (row_buf_policy == "DUEL" && duel_policies.size() < 2) {
+        std::cerr << "DUEL needs at least two duel_policies" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
 
     // Read static timeout cycles configuration
     static_timeout_cycles_ = GetInteger("system", "static_timeout_cycles", 100);
@@ -31,6 +31,14 @@ enum class RefreshPolicy {
     SIZE 
 };
 
+enum class QoSMode {
+    NONE,      // QoS class and deadline are ignored
+    STRICT,    // lower class always first
+    WEIGHTED,  // weighted fair share of service between classes
+    DEADLINE,  // earliest deadline first
+    SIZE
+};
+
 class Config {
    public:
     Config(std::string config_file, std::string out_dir);
@@ -130,14 +138,56 @@ class Config {
     bool unified_queue;
     int trans_queue_size;
     int write_buf_size;
+    int trans_per_cycle;
+    int row_hit_first_window;
+    int row_hit_cap;
+    bool adaptive_row_hit_cap;
+    int row_hit_cap_min;
+    int row_hit_cap_max;
+    int row_hit_cap_age_threshold;
+    int max_request_age;
+    double write_drain_high_watermark;
+    double write_drain_low_watermark;
+    double write_drain_idle_watermark;
+    bool write_drain_opportunistic;
+    bool write_drain_batch;
+    bool write_drain_per_rank;
+    bool bankgroup_interleave;
+    std::string cmd_scheduler;
+    int num_sources;
+    int parbs_marking_cap;
+    int tcm_quantum;
+    double tcm_cluster_threshold;
+    int tcm_shuffle_interval;
+    int bliss_threshold;
+    int bliss_clear_interval;
+    int rl_sched_budget;
+    QoSMode qos_mode;
+    int num_qos_classes;
+    std::vector<double> qos_weights;  // per class, WEIGHTED mode
+    std::vector<double> source_bw_limits;  // per source, share of peak
+    std::vector<double> source_bw_reservations;
+    int bw_bucket_depth;
+    bool prefetch_aware;
+    int prefetch_drop_threshold;
     bool enable_self_refresh;
     int sref_threshold;
     bool aggressive_precharging_enabled;
+    bool speculative_act_enabled;
+    int speculative_act_timeout;
+    bool row_prefetch_enabled;
+    int row_prefetch_degree;
+    int row_prefetch_buffer_size;
+    int row_prefetch_hit_latency;
     bool enable_hbm_dual_cmd;
 
 
     int epoch_period;
     int output_level;
+    bool row_hit_distance_stats;
+    uint64_t sample_window;
+    uint64_t sample_warmup;
+    uint64_t sample_interval;
     std::string output_dir;
     std::string output_prefix;
     std::string json_stats_name;
@@ -164,6 +214,10 @@ class Config {
 
     // Static timeout configuration
     int static_timeout_cycles_;  // Static timeout cycle count, 0 means disabled
+    // DUEL: candidate policies, leader banks per candidate, epoch (cycles)
+    std::vector<RowBufPolicy> duel_policies;
+    int duel_leaders;
+    int duel_epoch;
 
 #ifdef THERMAL
     std::string loc_mapping;
@@ -1,15 +1,9 @@
 #include "controller.h"
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <limits>
 
-// ===== Epoch Row Buffer Statistics (Global for ChampSim access) =====
-// Enable with -DENABLE_EPOCH_STATS compile flag
-#ifdef ENABLE_EPOCH_STATS
-uint64_t dramsim3_epoch_row_hits = 0;
-uint64_t dramsim3_epoch_row_misses = 0;
-#endif
-
 namespace dramsim3 {
 
 #ifdef THERMAL
@@ -20,6 +14,7 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
 #endif  // THERMAL
     : channel_id_(channel),
       clk_(0),
+      warm_cycles_(0),
       config_(config),
       simple_stats_(config_, channel_id_),
       channel_state_(config, timing),
@@ -33,8 +28,10 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
                       config.row_buf_policy == "FAPS"        ? RowBufPolicy::FAPS:
                       config.row_buf_policy == "RL_PAGE"     ? RowBufPolicy::RL_PAGE:
                       config.row_buf_policy == "STATIC_TIMEOUT" ? RowBufPolicy::STATIC_TIMEOUT:
+                      config.row_buf_policy == "DUEL"        ? RowBufPolicy::DUEL:
                       config.row_buf_policy == "ORACLE"      ? RowBufPolicy::ORACLE     : RowBufPolicy::OPEN_PAGE),this),
       refresh_(config, channel_state_),
+      row_tracker_(config.ranks * config.banks),
 #ifdef THERMAL
       thermal_calc_(thermal_calc),
 #endif  // THERMAL
@@ -48,13 +45,47 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
                       config.row_buf_policy == "FAPS"        ? RowBufPolicy::FAPS:
                       config.row_buf_policy == "RL_PAGE"     ? RowBufPolicy::RL_PAGE:
                       config.row_buf_policy == "STATIC_TIMEOUT" ? RowBufPolicy::STATIC_TIMEOUT:
+                      config.row_buf_policy == "DUEL"        ? RowBufPolicy::DUEL:
                       config.row_buf_policy == "ORACLE"      ? RowBufPolicy::ORACLE     : RowBufPolicy::OPEN_PAGE),
       last_trans_clk_(0),
-      write_draining_(0) {
+      write_draining_(0),
+      write_drain_rank_(0),
+      qos_arbiter_(config) {
 
 
       issuing_refresh_seq_ = false;
       issuing_sref_seq_ = false; 
+    track_rows_ = config_.row_hit_distance_stats ||
+                  cmd_queue_.PolicyActive(RowBufPolicy::DYMPL) ||
+                  cmd_queue_.PolicyActive(RowBufPolicy::GS) ||
+                  cmd_queue_.PolicyActive(RowBufPolicy::GS_NOHOTROW) ||
+                  cmd_queue_.PolicyActive(RowBufPolicy::STATIC_TIMEOUT);
+    if (UseProactivePrecharge()) {
+        proactive_confidence_.resize(config_.ranks * config_.banks, 2);
+        proactive_closed_row_.resize(config_.ranks * config_.banks, -1);
+    }
+    // the oracle policy must never see a demand-path ACT
+    if (config_.speculative_act_enabled &&
+        row_buf_policy_ != RowBufPolicy::ORACLE) {
+        next_row_predictor_ = std::unique_ptr<NextRowPredictor>(
+            new NextRowPredictor(config_.ranks * config_.banks));
+        spec_row_.resize(config_.ranks * config_.banks, -1);
+        spec_act_clk_.resize(config_.ranks * config_.banks, 0);
+        spec_armed_.resize(config_.ranks * config_.banks, false);
+    }
+    if (config_.row_prefetch_enabled) {
+        row_prefetch_src_.resize(config_.ranks * config_.banks);
+        row_prefetch_next_.resize(config_.ranks * config_.banks,
+                                  config_.row_prefetch_degree + 1);
+    }
+    for (int s = 0; s < config_.num_sources; s++) {
+        if (config_.source_bw_limits[s] > 0.0 ||
+            config_.source_bw_reservations[s] > 0.0) {
+            bw_regulator_ = std::unique_ptr<BandwidthRegulator>(
+                new BandwidthRegulator(config_));
+            break;
+        }
+    }
     if (is_unified_queue_) {
         unified_queue_.reserve(config_.trans_queue_size);
     } else {
@@ -77,7 +108,12 @@ Controller::Controller(int channel, const Config &config, const Timing &timing)
 #endif  // TRANS_TRACE
 }
 
-std::pair<uint64_t, int> Controller::ReturnDoneTrans(uint64_t clk) {
+int Controller::ReturnDoneTrans(uint64_t clk, Transaction &trans) {
+    if (!dropped_prefetches_.empty()) {
+        trans = dropped_prefetches_.back();
+        dropped_prefetches_.pop_back();
+        return 2;
+    }
     auto it = return_queue_.begin();
     while (it != return_queue_.end()) {
         if (clk >= it->complete_cycle) {
@@ -86,15 +122,32 @@ std::pair<uint64_t, int> Controller::ReturnDoneTrans(uint64_t clk) {
             } else {
                 simple_stats_.Increment("num_reads_done");
                 simple_stats_.AddValue("read_latency", clk_ - it->added_cycle);
+                if (row_buf_policy_ == RowBufPolicy::DUEL) {
+                    auto addr = config_.AddressMapping(it->addr);
+                    cmd_queue_.OnReadDone(addr.rank, addr.bankgroup, addr.bank,
+                                          clk_ - it->added_cycle);
+                }
+                if (it->is_prefetch) {
+                    simple_stats_.Increment("num_prefetches_done");
+                } else {
+                    simple_stats_.AddValue("demand_read_latency",
+                                           clk_ - it->added_cycle);
+                }
+                simple_stats_.AddReadDone(it->source_id, it->qos_class,
+                                          clk_ - it->added_cycle);
+                if (it->deadline != 0 && clk_ > it->deadline) {
+                    simple_stats_.IncrementVec("qos_deadline_misses",
+                                               it->qos_class);
+                }
             }
-            auto pair = std::make_pair(it->addr, it->is_write);
-            it = return_queue_.erase(it);
-            return pair;
+            trans = *it;
+            return_queue_.erase(it);
+            return trans.is_write ? 1 : 0;
         } else {
             ++it;
         }
     }
-    return std::make_pair(-1, -1);
+    return -1;
 }
 
 Address Controller::ReturnACT(uint64_t clk) {
@@ -111,6 +164,7 @@ void Controller::ClockTick() {
     refresh_.ClockTick();
 
     bool cmd_issued = false;
+    uint64_t issued_before = num_cmds_issued_;
     Command cmd;
     if (channel_state_.IsRefreshWaiting()) {
         cmd = cmd_queue_.FinishRefresh();
@@ -140,9 +194,14 @@ void Controller::ClockTick() {
             }
         }
     }
-    else if(row_buf_policy_==RowBufPolicy::GS || row_buf_policy_==RowBufPolicy::GS_NOHOTROW){ //GS policy timeout handling, can not issue timeout precharge when there is command issued
+    else if(cmd_queue_.PolicyActive(RowBufPolicy::GS) || cmd_queue_.PolicyActive(RowBufPolicy::GS_NOHOTROW)){ //GS policy timeout handling, can not issue timeout precharge when there is command issued
         //decrease timeout counter for each bank
         for(int i=0;i<cmd_queue_.num_queues_;i++){
+            auto policy = cmd_queue_.bank_policy_[i];
+            if (policy != RowBufPolicy::GS &&
+                policy != RowBufPolicy::GS_NOHOTROW) {
+                continue;  // DUEL bank running another policy
+            }
             if(cmd_queue_.timeout_ticking[i] && cmd_queue_.timeout_counter[i]>0){
                 cmd_queue_.timeout_counter[i]--;
             }
@@ -154,7 +213,7 @@ void Controller::ClockTick() {
                 //check sending precharge timing is ok
                 auto& bs=channel_state_.bank_states_[cmd.Rank()][cmd.Bankgroup()][cmd.Bank()];
                 if(bs.IsRowOpen() && bs.cmd_timing_[static_cast<int>(CommandType::PRECHARGE)]<=clk_){
-                    if (row_buf_policy_ == RowBufPolicy::GS) {
+                    if (policy == RowBufPolicy::GS) {
                         // Row Exclusion check: if row is in exclusion store, delay precharge
                         if (cmd_queue_.RE_IsInStore(cmd.Rank(), cmd.Bankgroup(), cmd.Bank(), cmd.Row())) {
                             // RE hit: count and track for verification
@@ -220,6 +279,19 @@ void Controller::ClockTick() {
             }
         }
     }
+    else if (UseProactivePrecharge() && !channel_state_.IsRefreshWaiting()) {
+        IssueProactivePrecharge();
+    }
+
+    if (next_row_predictor_ && num_cmds_issued_ == issued_before &&
+        !channel_state_.IsRefreshWaiting()) {
+        IssueSpeculativeCommand();
+    }
+
+    if (config_.row_prefetch_enabled && num_cmds_issued_ == issued_before &&
+        !channel_state_.IsRefreshWaiting()) {
+        IssueRowPrefetch();
+    }
 
 
     // power updates pt 1
@@ -275,6 +347,17 @@ void Controller::ClockTick() {
         }
     }
 
+    if (config_.prefetch_drop_threshold > 0) {
+        DropStalePrefetches();
+    }
+    if (bw_regulator_) {
+        bw_regulator_->ClockTick();
+        for (int s = 0; s < config_.num_sources; s++) {
+            if (bw_regulator_->Limited(s)) {
+                simple_stats_.IncrementVec("source_throttled_cycles", s);
+            }
+        }
+    }
     ScheduleTransaction();
 
     // Sample queue occupancy for statistics
@@ -317,10 +400,50 @@ bool Controller::WillAcceptTransaction(uint64_t hex_addr, bool is_write) const {
     }
 }
 
+bool Controller::WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                       int source_id) const {
+    if (bw_regulator_ && bw_regulator_->Limited(source_id)) {
+        return false;
+    }
+    return WillAcceptTransaction(hex_addr, is_write);
+}
+
+void Controller::SetSourceBandwidth(int source_id, double limit,
+                                    double reservation) {
+    if (!bw_regulator_) {
+        bw_regulator_ = std::unique_ptr<BandwidthRegulator>(
+            new BandwidthRegulator(config_));
+    }
+    bw_regulator_->SetSource(source_id, limit, reservation);
+}
+
 bool Controller::AddTransaction(Transaction trans) {
     trans.added_cycle = clk_;
+    if (trans.source_id < 0 || trans.source_id >= config_.num_sources) {
+        trans.source_id = config_.num_sources - 1;
+    }
+    if (trans.qos_class < 0 || trans.qos_class >= config_.num_qos_classes) {
+        trans.qos_class = config_.num_qos_classes - 1;
+    }
+    if (trans.deadline != 0) {
+        trans.deadline += clk_;
+    }
+    if (trans.is_prefetch) {
+        simple_stats_.Increment("num_prefetches");
+    }
     simple_stats_.AddValue("interarrival_latency", clk_ - last_trans_clk_);
     last_trans_clk_ = clk_;
+    if (track_rows_) {
+        auto addr = config_.AddressMapping(trans.addr);
+        int bank_idx = BankIndex(addr.rank, addr.bankgroup, addr.bank);
+        uint64_t warm_clk = clk_ + warm_cycles_;
+        uint64_t last_touch;
+        if (config_.row_hit_distance_stats &&
+            row_tracker_.LastTouch(bank_idx, addr.row, last_touch)) {
+            simple_stats_.AddRowHitDistance(warm_clk - last_touch);
+        }
+        row_tracker_.Touch(bank_idx, addr.row, warm_clk);
+    }
 
 #ifdef TRANS_TRACE
     auto cmd = TransToCommand(trans);
@@ -330,8 +453,12 @@ bool Controller::AddTransaction(Transaction trans) {
 #endif  // TRANS_TRACE
 
     if (trans.is_write) {
+        if (config_.row_prefetch_enabled) {
+            InvalidateRowPrefetch(trans.addr);
+        }
         if (pending_wr_q_.count(trans.addr) == 0) {  // can not merge writes
             pending_wr_q_.insert(std::make_pair(trans.addr, trans));
+            CountPendingLine(trans.addr, 1);
             if (is_unified_queue_) {
                 unified_queue_.push_back(trans);
             } else {
@@ -348,49 +475,365 @@ bool Controller::AddTransaction(Transaction trans) {
             return_queue_.push_back(trans);
             return true;
         }
-        pending_rd_q_.insert(std::make_pair(trans.addr, trans));
-        if (pending_rd_q_.count(trans.addr) == 1) {
+        if (config_.row_prefetch_enabled && ServeFromRowPrefetch(trans)) {
+            return true;
+        }
+        auto &reads = pending_rd_q_[trans.addr];
+        reads.push_back(trans);
+        if (reads.size() == 1) {
+            CountPendingLine(trans.addr, 1);
             if (is_unified_queue_) {
                 unified_queue_.push_back(trans);
             } else {
                 read_queue_.push_back(trans);
             }
+        } else if (!trans.is_prefetch) {
+            // a demand for a prefetched line, the prefetch was useful
+            auto &queue = is_unified_queue_ ? unified_queue_ : read_queue_;
+            for (auto &queued : queue) {
+                if (queued.addr == trans.addr && queued.is_prefetch) {
+                    queued.is_prefetch = false;
+                    simple_stats_.Increment("num_prefetch_upgrades");
+                }
+            }
+            auto addr = config_.AddressMapping(trans.addr);
+            cmd_queue_.UpgradePrefetch(addr.rank, addr.bankgroup, addr.bank,
+                                       trans.addr);
         }
         return true;
     }
 }
 
+void Controller::WarmTransaction(const Transaction &trans, uint64_t cycle) {
+    uint64_t warm_clk = clk_ + warm_cycles_ + cycle;
+    auto addr = config_.AddressMapping(trans.addr);
+    int bank_idx = BankIndex(addr.rank, addr.bankgroup, addr.bank);
+    int queue_idx = cmd_queue_.GetQueueIndex(addr.rank, addr.bankgroup,
+                                             addr.bank);
+    if (trans.is_write && config_.row_prefetch_enabled) {
+        InvalidateRowPrefetch(trans.addr);
+    }
+    if (channel_state_.IsRankSelfRefreshing(addr.rank)) {
+        row_tracker_.Touch(bank_idx, addr.row, warm_clk);
+        return;
+    }
+
+    // a timeout policy may have closed the open row since its last access
+    bool row_open = channel_state_.IsRowOpen(addr.rank, addr.bankgroup,
+                                             addr.bank);
+    int open_row = channel_state_.OpenRow(addr.rank, addr.bankgroup, addr.bank);
+    uint64_t last_touch;
+    if (row_open) {
+        uint64_t idle = UINT64_MAX;
+        if (row_tracker_.LastTouch(bank_idx, open_row, last_touch)) {
+            idle = warm_clk > last_touch ? warm_clk - last_touch : 0;
+        }
+        if (cmd_queue_.WarmTimeout(queue_idx, open_row, idle)) {
+            channel_state_.UpdateState(
+                Command(CommandType::PRECHARGE, addr, trans.addr));
+            row_open = false;
+        }
+    }
+    row_tracker_.Touch(bank_idx, addr.row, warm_clk);
+
+    bool row_hit = row_open && open_row == addr.row;
+    if (!row_hit) {
+        if (row_open) {
+            channel_state_.UpdateState(
+                Command(CommandType::PRECHARGE, addr, trans.addr));
+        }
+        channel_state_.UpdateState(
+            Command(CommandType::ACTIVATE, addr, trans.addr));
+        cmd_queue_.WarmActivate(queue_idx, addr.row, warm_clk);
+        if (next_row_predictor_) {
+            next_row_predictor_->OnActivate(bank_idx, addr.row);
+        }
+    }
+    Command cmd(trans.is_write ? CommandType::WRITE : CommandType::READ, addr,
+                trans.addr);
+    if (cmd_queue_.WarmAccess(queue_idx, cmd, row_hit, warm_clk)) {
+        cmd.cmd_type = trans.is_write ? CommandType::WRITE_PRECHARGE
+                                      : CommandType::READ_PRECHARGE;
+    }
+    channel_state_.UpdateState(cmd);
+}
+
+void Controller::EndWarmup(uint64_t cycles) {
+    warm_cycles_ += cycles;
+    cmd_queue_.EndWarmup(cycles);
+}
+
 void Controller::ScheduleTransaction() {
     // determine whether to schedule read or write
-    // read/write arbiter,very simple here, we can make it more advanced and complex TODO
-    if (write_draining_ == 0 && !is_unified_queue_) {
-        // we basically have an upper and lower threshold for write buffer
-        if ((write_buffer_.size() >= 7*write_buffer_.capacity()/8) ||
-            (write_buffer_.size() > write_buffer_.capacity()/2 && cmd_queue_.QueueEmpty())) {
-            write_draining_ = write_buffer_.size();
-        }
+    if (!is_unified_queue_) {
+        UpdateWriteDrainState();
     }
 
-    std::vector<Transaction> &queue =
-        is_unified_queue_ ? unified_queue_
-                          : write_draining_ > 0 ? write_buffer_ : read_queue_;
-    for (auto it = queue.begin(); it != queue.end(); it++) {
-        auto cmd = TransToCommand(*it);
-        if (cmd_queue_.WillAcceptCommand(cmd.Rank(), cmd.Bankgroup(),
-                                         cmd.Bank())) {
-            if (!is_unified_queue_ && cmd.IsWrite()) {
-                // Enforce R->W dependency
-                if (pending_rd_q_.count(it->addr) > 0) {
-                    write_draining_ = 0;
-                    break;
+    for (int n = 0; n < config_.trans_per_cycle; n++) {
+        bool opportunistic = false;
+        std::vector<Transaction> *queue;
+        std::vector<Transaction>::iterator it;
+        if (is_unified_queue_) {
+            queue = &unified_queue_;
+            it = PickTransaction(*queue);
+        } else if (write_draining_ > 0) {
+            queue = &write_buffer_;
+            it = PickDrainWrite();
+        } else {
+            queue = &read_queue_;
+            it = PickTransaction(*queue);
+            if (it == queue->end() && config_.write_drain_opportunistic) {
+                auto wr_it = PickIdleRankWrite();
+                if (wr_it != write_buffer_.end()) {
+                    queue = &write_buffer_;
+                    it = wr_it;
+                    opportunistic = true;
                 }
+            }
+        }
+        if (it == queue->end()) {
+            break;
+        }
+        auto cmd = TransToCommand(*it);
+        if (!is_unified_queue_ && cmd.IsWrite()) {
+            // Enforce R->W dependency
+            if (pending_rd_q_.count(it->addr) > 0) {
+                write_draining_ = 0;
+                break;
+            }
+            if (opportunistic) {
+                simple_stats_.Increment("num_opportunistic_writes");
+            } else {
                 write_draining_ -= 1;
             }
-            cmd_queue_.AddCommand(cmd);
-            queue.erase(it);
+        }
+        if (qos_arbiter_.Enabled()) {
+            qos_arbiter_.OnServed(it->qos_class);
+        }
+        cmd_queue_.AddCommand(cmd);
+        queue->erase(it);
+    }
+}
+
+void Controller::UpdateWriteDrainState() {
+    if (write_draining_ != 0) {
+        return;
+    }
+    size_t cap = write_buffer_.capacity();
+    size_t size = write_buffer_.size();
+    auto high = static_cast<size_t>(config_.write_drain_high_watermark * cap);
+    auto idle = static_cast<size_t>(config_.write_drain_idle_watermark * cap);
+    if (size >= high || (size > idle && cmd_queue_.QueueEmpty())) {
+        auto low = static_cast<size_t>(config_.write_drain_low_watermark * cap);
+        write_draining_ = size > low ? static_cast<int>(size - low) : 0;
+        if (write_draining_ > 0) {
+            simple_stats_.Increment("num_write_drains");
+            if (config_.write_drain_per_rank) {
+                write_drain_rank_ = BusiestWriteRank();
+            }
+        }
+    }
+}
+
+std::vector<Transaction>::iterator Controller::PickDrainWrite() {
+    if (!config_.write_drain_batch && !config_.write_drain_per_rank) {
+        return PickTransaction(write_buffer_);
+    }
+    if (!config_.write_drain_per_rank) {
+        return PickWrite(-1);
+    }
+    // stay on one rank for the whole burst to avoid paying tRTRS between
+    // ranks, only move on once that rank has no writes left
+    auto it = PickWrite(write_drain_rank_);
+    if (it != write_buffer_.end()) {
+        return it;
+    }
+    for (const auto &trans : write_buffer_) {
+        if (config_.AddressMapping(trans.addr).rank == write_drain_rank_) {
+            return write_buffer_.end();  // bank queues full, wait for them
+        }
+    }
+    int next_rank = BusiestWriteRank();
+    if (next_rank == write_drain_rank_) {
+        return write_buffer_.end();
+    }
+    write_drain_rank_ = next_rank;
+    simple_stats_.Increment("num_write_drain_rank_switches");
+    return PickWrite(write_drain_rank_);
+}
+
+std::vector<Transaction>::iterator Controller::PickWrite(int rank) {
+    // rank < 0 matches any rank, with batching on, writes to an open or
+    // already queued row go first so a drain burst costs fewer ACTs
+    auto first_ready = write_buffer_.end();
+    for (auto it = write_buffer_.begin(); it != write_buffer_.end(); it++) {
+        auto addr = config_.AddressMapping(it->addr);
+        if (rank >= 0 && addr.rank != rank) {
+            continue;
+        }
+        if (!cmd_queue_.WillAcceptCommand(addr.rank, addr.bankgroup,
+                                          addr.bank)) {
+            continue;
+        }
+        if (!config_.write_drain_batch) {
+            return it;
+        }
+        if (first_ready == write_buffer_.end()) {
+            first_ready = it;
+        }
+        if (IsRowHitCandidate(*it, addr)) {
+            if (it != first_ready) {
+                simple_stats_.Increment("num_write_drain_batched");
+            }
+            return it;
+        }
+    }
+    return first_ready;
+}
+
+std::vector<Transaction>::iterator Controller::PickIdleRankWrite() {
+    // a rank without any queued read can absorb writes without delaying reads
+    std::vector<int> rank_reads(config_.ranks, 0);
+    for (const auto &trans : read_queue_) {
+        rank_reads[config_.AddressMapping(trans.addr).rank]++;
+    }
+    for (auto it = write_buffer_.begin(); it != write_buffer_.end(); it++) {
+        auto addr = config_.AddressMapping(it->addr);
+        if (rank_reads[addr.rank] > 0 || pending_rd_q_.count(it->addr) > 0) {
+            continue;
+        }
+        if (cmd_queue_.WillAcceptCommand(addr.rank, addr.bankgroup,
+                                         addr.bank)) {
+            return it;
+        }
+    }
+    return write_buffer_.end();
+}
+
+int Controller::BusiestWriteRank() const {
+    std::vector<int> rank_writes(config_.ranks, 0);
+    for (const auto &trans : write_buffer_) {
+        rank_writes[config_.AddressMapping(trans.addr).rank]++;
+    }
+    int busiest = write_drain_rank_;
+    for (int r = 0; r < config_.ranks; r++) {
+        if (rank_writes[r] > rank_writes[busiest]) {
+            busiest = r;
+        }
+    }
+    return busiest;
+}
+
+void Controller::DropStalePrefetches() {
+    auto &queue = is_unified_queue_ ? unified_queue_ : read_queue_;
+    auto it = queue.begin();
+    while (it != queue.end()) {
+        if (!it->is_prefetch ||
+            clk_ - it->added_cycle <
+                static_cast<uint64_t>(config_.prefetch_drop_threshold)) {
+            ++it;
+            continue;
+        }
+        // only prefetches wait on this address, report every one of them
+        auto pending = pending_rd_q_.find(it->addr);
+        for (const auto &trans : pending->second) {
+            dropped_prefetches_.push_back(trans);
+            simple_stats_.Increment("num_prefetches_dropped");
+        }
+        pending_rd_q_.erase(pending);
+        CountPendingLine(it->addr, -1);
+        it = queue.erase(it);
+    }
+}
+
+std::vector<Transaction>::iterator Controller::PickTransaction(
+    std::vector<Transaction> &queue) {
+    if (config_.prefetch_aware) {
+        auto it = PickTransaction(queue, true);
+        if (it != queue.end()) {
+            return it;
+        }
+    }
+    return PickTransaction(queue, false);
+}
+
+std::vector<Transaction>::iterator Controller::PickTransaction(
+    std::vector<Transaction> &queue, bool demand_only) {
+    if (qos_arbiter_.Enabled()) {
+        return PickQoSTransaction(queue, demand_only);
+    }
+    // FCFS among transactions whose bank queue has room, except that within
+    // the first row_hit_first_window entries a transaction targeting an open
+    // or already queued row is taken first
+    auto first_ready = queue.end();
+    int window = config_.row_hit_first_window;
+    int pos = 0;
+    for (auto it = queue.begin(); it != queue.end(); it++, pos++) {
+        if (first_ready != queue.end() && pos >= window) {
             break;
         }
+        if (demand_only && it->is_prefetch) {
+            continue;
+        }
+        auto addr = config_.AddressMapping(it->addr);
+        if (!cmd_queue_.WillAcceptCommand(addr.rank, addr.bankgroup,
+                                          addr.bank)) {
+            continue;
+        }
+        if (first_ready == queue.end()) {
+            first_ready = it;
+        }
+        if (pos < window && IsRowHitCandidate(*it, addr)) {
+            if (it != first_ready) {
+                simple_stats_.Increment("num_trans_row_hit_promoted");
+            }
+            return it;
+        }
+    }
+    return first_ready;
+}
+
+std::vector<Transaction>::iterator Controller::PickQoSTransaction(
+    std::vector<Transaction> &queue, bool demand_only) {
+    // best QoS order first, then row hits, then age
+    auto best = queue.end();
+    bool best_hit = false;
+    for (auto it = queue.begin(); it != queue.end(); it++) {
+        if (demand_only && it->is_prefetch) {
+            continue;
+        }
+        auto addr = config_.AddressMapping(it->addr);
+        if (!cmd_queue_.WillAcceptCommand(addr.rank, addr.bankgroup,
+                                          addr.bank)) {
+            continue;
+        }
+        bool hit = IsRowHitCandidate(*it, addr);
+        if (best == queue.end() ||
+            qos_arbiter_.Before(it->qos_class, it->deadline, best->qos_class,
+                                best->deadline) ||
+            (hit && !best_hit &&
+             qos_arbiter_.Tie(it->qos_class, it->deadline, best->qos_class,
+                              best->deadline))) {
+            best = it;
+            best_hit = hit;
+        }
+    }
+    return best;
+}
+
+bool Controller::IsRowHitCandidate(const Transaction &trans,
+                                   const Address &addr) const {
+    // never let a write overtake a pending read to the same address
+    if (trans.is_write && pending_rd_q_.count(trans.addr) > 0) {
+        return false;
+    }
+    if (channel_state_.IsRowOpen(addr.rank, addr.bankgroup, addr.bank) &&
+        channel_state_.OpenRow(addr.rank, addr.bankgroup, addr.bank) ==
+            addr.row) {
+        return true;
     }
+    return cmd_queue_.HasRowInQueue(addr.rank, addr.bankgroup, addr.bank,
+                                    addr.row);
 }
 
 void Controller::IssueCommand(const Command &cmd) {
@@ -401,6 +844,7 @@ void Controller::IssueCommand(const Command &cmd) {
     // add channel in, only needed by thermal module
     thermal_calc_.UpdateCMDPower(channel_id_, cmd, clk_);
 #endif  // THERMAL
+    num_cmds_issued_++;
 
     // --- Classification & invariant checks for PRE/ACT sources ---
     if (cmd.cmd_type == CommandType::PRECHARGE) {
@@ -408,17 +852,44 @@ void Controller::IssueCommand(const Command &cmd) {
             simple_stats_.Increment("num_pre_for_refresh");
         } else if (issuing_sref_seq_) {
             simple_stats_.Increment("num_pre_for_sref");
+        } else if (issuing_proactive_pre_) {
+            simple_stats_.Increment("num_pre_for_proactive");
+        } else if (issuing_spec_seq_) {
+            simple_stats_.Increment("num_pre_for_speculation");
         } else {
             simple_stats_.Increment("num_pre_for_demand");
         }
     } else if (cmd.cmd_type == CommandType::ACTIVATE) {
         if (issuing_sref_seq_) {
             simple_stats_.Increment("num_act_for_sref");
+        } else if (issuing_spec_seq_) {
+            simple_stats_.Increment("num_act_for_speculation");
         } else {
             simple_stats_.Increment("num_act_for_demand");
         }
     }
 
+    if (issuing_row_prefetch_) {
+        // no request behind it, only timing and stats are updated. The bank
+        // state is left alone: a READ to the open row would only count as a
+        // row hit, which the row hit cap and RL_PAGE take as demand
+        simple_stats_.Increment("num_row_prefetch_reads");
+        UpdateCommandStats(cmd);
+        channel_state_.UpdateTiming(cmd, clk_);
+        return;
+    }
+    if (!proactive_confidence_.empty()) {
+        UpdateProactiveState(cmd);
+    }
+    if (next_row_predictor_ && !cmd.IsRankCMD()) {
+        UpdateSpeculativeState(cmd);
+    }
+    if (config_.row_prefetch_enabled && cmd.IsRead()) {
+        int idx = BankIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
+        row_prefetch_src_[idx] = cmd.addr;
+        row_prefetch_next_[idx] = 1;
+    }
+
     // Invariant (Oracle): demand path must not issue ACT/PRE
     if (row_buf_policy_ == RowBufPolicy::ORACLE &&
         (cmd.cmd_type == CommandType::ACTIVATE || cmd.cmd_type == CommandType::PRECHARGE) &&
@@ -430,19 +901,18 @@ void Controller::IssueCommand(const Command &cmd) {
 
     // if read/write, update pending queue and return queue
     if (cmd.IsRead()) {
-        auto num_reads = pending_rd_q_.count(cmd.hex_addr);
-        if (num_reads == 0) {
+        auto it = pending_rd_q_.find(cmd.hex_addr);
+        if (it == pending_rd_q_.end()) {
             std::cerr << cmd.hex_addr << " not in read queue! " << std::endl;
             exit(1);
         }
         // if there are multiple reads pending return them all
-        while (num_reads > 0) {
-            auto it = pending_rd_q_.find(cmd.hex_addr);
-            it->second.complete_cycle = clk_ + config_.read_delay;
-            return_queue_.push_back(it->second);
-            pending_rd_q_.erase(it);
-            num_reads -= 1;
+        for (auto &trans : it->second) {
+            trans.complete_cycle = clk_ + config_.read_delay;
+            return_queue_.push_back(trans);
         }
+        pending_rd_q_.erase(it);
+        CountPendingLine(cmd.hex_addr, -1);
     } else if (cmd.IsWrite()) {
         // there should be only 1 write to the same location at a time
         auto it = pending_wr_q_.find(cmd.hex_addr);
@@ -453,6 +923,7 @@ void Controller::IssueCommand(const Command &cmd) {
         auto wr_lat = clk_ - it->second.added_cycle + config_.write_delay;
         simple_stats_.AddValue("write_latency", wr_lat);
         pending_wr_q_.erase(it);
+        CountPendingLine(cmd.hex_addr, -1);
     } else if (cmd.cmd_type == CommandType::ACTIVATE) {
         act_queue_.push_back(Address(channel_id_, cmd.Rank(), 0, 
                                     (8*cmd.Bank() + cmd.Bankgroup()), 
@@ -463,6 +934,273 @@ void Controller::IssueCommand(const Command &cmd) {
     channel_state_.UpdateTimingAndStates(cmd, clk_);
 }
 
+void Controller::IssueRowPrefetch() {
+    int num_banks = static_cast<int>(row_prefetch_src_.size());
+    int lines_per_row = config_.columns / config_.BL;
+    for (int n = 0; n < num_banks; n++) {
+        int idx = (row_prefetch_bank_idx_ + n) % num_banks;
+        if (row_prefetch_next_[idx] > config_.row_prefetch_degree) {
+            continue;
+        }
+        Address addr = row_prefetch_src_[idx];
+        addr.column += row_prefetch_next_[idx];
+        if (addr.column >= lines_per_row ||
+            channel_state_.OpenRow(addr.rank, addr.bankgroup, addr.bank) !=
+                addr.row ||
+            !channel_state_.IsRowOpen(addr.rank, addr.bankgroup, addr.bank)) {
+            row_prefetch_next_[idx] = config_.row_prefetch_degree + 1;
+            continue;
+        }
+        uint64_t hex_addr = config_.GetHexAddress(addr);
+        bool cached = false;
+        for (const auto &entry : row_prefetch_buf_) {
+            if (entry.addr == hex_addr) {
+                cached = true;
+                break;
+            }
+        }
+        if (cached || HasPendingLine(hex_addr)) {
+            row_prefetch_next_[idx]++;
+            continue;
+        }
+        auto ready = channel_state_.GetReadyCommand(
+            Command(CommandType::READ, addr, hex_addr), clk_);
+        if (!ready.IsValid() || ready.cmd_type != CommandType::READ) {
+            continue;
+        }
+        row_prefetch_bank_idx_ = (idx + 1) % num_banks;
+        row_prefetch_next_[idx]++;
+        issuing_row_prefetch_ = true;
+        IssueCommand(ready);
+        issuing_row_prefetch_ = false;
+        if (static_cast<int>(row_prefetch_buf_.size()) >=
+            config_.row_prefetch_buffer_size) {
+            if (!row_prefetch_buf_.front().used) {
+                simple_stats_.Increment("row_prefetch_evicted_unused");
+            }
+            row_prefetch_buf_.pop_front();
+        }
+        row_prefetch_buf_.push_back({hex_addr, clk_ + config_.read_delay, false});
+        return;
+    }
+}
+
+bool Controller::HasPendingLine(uint64_t line_addr) const {
+    return pending_lines_.count(line_addr) > 0;
+}
+
+void Controller::CountPendingLine(uint64_t hex_addr, int delta) {
+    if (!config_.row_prefetch_enabled) {
+        return;
+    }
+    uint64_t line_addr = LineAddress(hex_addr);
+    int &count = pending_lines_[line_addr];
+    count += delta;
+    if (count == 0) {
+        pending_lines_.erase(line_addr);
+    }
+}
+
+bool Controller::ServeFromRowPrefetch(Transaction &trans) {
+    uint64_t line_addr = LineAddress(trans.addr);
+    for (auto &entry : row_prefetch_buf_) {
+        if (entry.addr != line_addr) {
+            continue;
+        }
+        if (!entry.used) {
+            entry.used = true;
+            simple_stats_.Increment("row_prefetch_useful");
+        }
+        simple_stats_.Increment("row_prefetch_hits");
+        trans.complete_cycle = std::max(clk_, entry.ready_clk) +
+                               config_.row_prefetch_hit_latency;
+        return_queue_.push_back(trans);
+        return true;
+    }
+    return false;
+}
+
+void Controller::InvalidateRowPrefetch(uint64_t hex_addr) {
+    uint64_t line_addr = LineAddress(hex_addr);
+    for (auto it = row_prefetch_buf_.begin(); it != row_prefetch_buf_.end();
+         it++) {
+        if (it->addr == line_addr) {
+            row_prefetch_buf_.erase(it);
+            return;
+        }
+    }
+}
+
+bool Controller::UseProactivePrecharge() const {
+    // policies that make their own close decisions are left alone
+    return config_.aggressive_precharging_enabled &&
+           (row_buf_policy_ == RowBufPolicy::OPEN_PAGE ||
+            row_buf_policy_ == RowBufPolicy::SMART_CLOSE ||
+            row_buf_policy_ == RowBufPolicy::DPM);
+}
+
+void Controller::IssueProactivePrecharge() {
+    int num_banks = static_cast<int>(proactive_confidence_.size());
+    for (int n = 0; n < num_banks; n++) {
+        int idx = (proactive_bank_idx_ + n) % num_banks;
+        if (proactive_confidence_[idx] < 2 ||
+            (!spec_row_.empty() && spec_row_[idx] >= 0)) {
+            continue;
+        }
+        int rank = idx / config_.banks;
+        int bankgroup = (idx % config_.banks) / config_.banks_per_group;
+        int bank = idx % config_.banks_per_group;
+        auto &bs = channel_state_.bank_states_[rank][bankgroup][bank];
+        if (!bs.IsRowOpen() ||
+            bs.cmd_timing_[static_cast<int>(CommandType::PRECHARGE)] > clk_) {
+            continue;
+        }
+        Address addr(channel_id_, rank, bankgroup, bank, bs.OpenRow(), 0);
+        if (HasPendingAccess(addr, false)) {
+            continue;
+        }
+        proactive_bank_idx_ = (idx + 1) % num_banks;
+        issuing_proactive_pre_ = true;
+        IssueCommand(Command(CommandType::PRECHARGE, addr, -1));
+        issuing_proactive_pre_ = false;
+        return;
+    }
+}
+
+void Controller::UpdateProactiveState(const Command &cmd) {
+    int idx = BankIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
+    auto &conf = proactive_confidence_[idx];
+    if (cmd.cmd_type == CommandType::PRECHARGE) {
+        if (issuing_proactive_pre_) {
+            proactive_closed_row_[idx] = cmd.Row();
+        } else if (!issuing_refresh_seq_ && !issuing_sref_seq_) {
+            // a conflict closed the row on demand, closing early would have
+            // taken the tRP off the critical path
+            conf = std::min(conf + 1, 3);
+        }
+    } else if (cmd.cmd_type == CommandType::ACTIVATE &&
+               proactive_closed_row_[idx] >= 0) {
+        if (cmd.Row() == proactive_closed_row_[idx]) {
+            simple_stats_.Increment("num_proactive_pre_same_row");
+            conf = std::max(conf - 1, 0);
+        } else {
+            simple_stats_.Increment("num_proactive_pre_useful");
+            conf = std::min(conf + 1, 3);
+        }
+        proactive_closed_row_[idx] = -1;
+    }
+}
+
+bool Controller::HasPendingAccess(const Address &addr, bool any_row) const {
+    int row = any_row ? -1 : addr.row;
+    if (cmd_queue_.HasRowInQueue(addr.rank, addr.bankgroup, addr.bank, row)) {
+        return true;
+    }
+    for (const auto *queue : {&unified_queue_, &read_queue_, &write_buffer_}) {
+        for (const auto &trans : *queue) {
+            auto t_addr = config_.AddressMapping(trans.addr);
+            if (t_addr.rank == addr.rank && t_addr.bankgroup == addr.bankgroup &&
+                t_addr.bank == addr.bank && (any_row || t_addr.row == addr.row)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int Controller::BankIndex(int rank, int bankgroup, int bank) const {
+    return rank * config_.banks + bankgroup * config_.banks_per_group + bank;
+}
+
+void Controller::IssueSpeculativeCommand() {
+    int num_banks = static_cast<int>(spec_row_.size());
+    // close speculative rows nobody asked for
+    for (int idx = 0; idx < num_banks; idx++) {
+        if (spec_row_[idx] < 0 ||
+            clk_ - spec_act_clk_[idx] <
+                static_cast<uint64_t>(config_.speculative_act_timeout)) {
+            continue;
+        }
+        int rank = idx / config_.banks;
+        int bankgroup = (idx % config_.banks) / config_.banks_per_group;
+        int bank = idx % config_.banks_per_group;
+        auto &bs = channel_state_.bank_states_[rank][bankgroup][bank];
+        Address addr(channel_id_, rank, bankgroup, bank, spec_row_[idx], 0);
+        if (!bs.IsRowOpen() ||
+            bs.cmd_timing_[static_cast<int>(CommandType::PRECHARGE)] > clk_ ||
+            HasPendingAccess(addr, false)) {
+            continue;
+        }
+        simple_stats_.Increment("spec_act_timeouts");
+        issuing_spec_seq_ = true;
+        IssueCommand(Command(CommandType::PRECHARGE, addr, -1));
+        issuing_spec_seq_ = false;
+        return;
+    }
+
+    // open the predicted row of an idle closed bank
+    for (int n = 0; n < num_banks; n++) {
+        int idx = (spec_bank_idx_ + n) % num_banks;
+        if (!spec_armed_[idx] || spec_row_[idx] >= 0) {
+            continue;
+        }
+        int row = next_row_predictor_->Predict(idx);
+        if (row < 0 || row >= config_.rows) {
+            continue;
+        }
+        int rank = idx / config_.banks;
+        int bankgroup = (idx % config_.banks) / config_.banks_per_group;
+        int bank = idx % config_.banks_per_group;
+        if (channel_state_.IsRankSelfRefreshing(rank) ||
+            channel_state_.IsRowOpen(rank, bankgroup, bank)) {
+            continue;
+        }
+        Address addr(channel_id_, rank, bankgroup, bank, row, 0);
+        if (HasPendingAccess(addr, true)) {
+            continue;  // a demand ACT is on its way
+        }
+        // tRP, tRRD and tFAW are all checked through the ACT readiness
+        auto ready = channel_state_.GetReadyCommand(
+            Command(CommandType::READ, addr, -1), clk_);
+        if (!ready.IsValid() || ready.cmd_type != CommandType::ACTIVATE) {
+            continue;
+        }
+        spec_bank_idx_ = (idx + 1) % num_banks;
+        issuing_spec_seq_ = true;
+        IssueCommand(ready);
+        issuing_spec_seq_ = false;
+        return;
+    }
+}
+
+void Controller::UpdateSpeculativeState(const Command &cmd) {
+    int idx = BankIndex(cmd.Rank(), cmd.Bankgroup(), cmd.Bank());
+    if (cmd.cmd_type == CommandType::ACTIVATE) {
+        if (issuing_spec_seq_) {
+            spec_row_[idx] = cmd.Row();
+            spec_act_clk_[idx] = clk_;
+            spec_armed_[idx] = false;
+            simple_stats_.Increment("spec_acts");
+        } else {
+            next_row_predictor_->OnActivate(idx, cmd.Row());
+            spec_armed_[idx] = true;
+        }
+    } else if (cmd.IsReadWrite()) {
+        if (spec_row_[idx] >= 0 && spec_row_[idx] == cmd.Row()) {
+            // the demand ACT was saved, train as if it had happened
+            simple_stats_.Increment("spec_act_hits");
+            next_row_predictor_->OnActivate(idx, cmd.Row());
+            spec_armed_[idx] = true;
+            spec_row_[idx] = -1;
+        }
+    } else if (cmd.cmd_type == CommandType::PRECHARGE) {
+        if (spec_row_[idx] >= 0) {
+            simple_stats_.Increment("spec_act_misses");
+            spec_row_[idx] = -1;
+        }
+    }
+}
+
 Command Controller::TransToCommand(const Transaction &trans)const {
     auto addr = config_.AddressMapping(trans.addr);
     CommandType cmd_type;
@@ -472,11 +1210,78 @@ Command Controller::TransToCommand(const Transaction &trans)const {
         cmd_type = trans.is_write ? CommandType::WRITE
                                   : CommandType::READ;
     }
-    return Command(cmd_type, addr, trans.addr);
+    Command cmd(cmd_type, addr, trans.addr);
+    cmd.source_id = trans.source_id;
+    cmd.added_cycle = trans.added_cycle;
+    cmd.qos_class = trans.qos_class;
+    cmd.deadline = trans.deadline;
+    cmd.is_prefetch = trans.is_prefetch;
+    cmd.id = trans.id;
+    cmd.meta = trans.meta;
+    return cmd;
 }
 
 int Controller::QueueUsage() const { return cmd_queue_.QueueUsage(); }
 
+void Controller::Serialize(Checkpoint &ckpt) {
+    ckpt.Section("channel " + std::to_string(channel_id_));
+    ckpt.Field(clk_);
+    ckpt.Field(warm_cycles_);
+    simple_stats_.Serialize(ckpt);
+    channel_state_.Serialize(ckpt);
+    cmd_queue_.Serialize(ckpt);
+    refresh_.Serialize(ckpt);
+    row_tracker_.Serialize(ckpt);
+    ckpt.Field(unified_queue_);
+    ckpt.Field(read_queue_);
+    ckpt.Field(write_buffer_);
+    ckpt.Field(pending_rd_q_);
+    ckpt.Field(pending_wr_q_);
+    if (ckpt.Restoring()) {
+        pending_lines_.clear();
+        for (const auto &it : pending_rd_q_) {
+            CountPendingLine(it.first, 1);
+        }
+        for (const auto &it : pending_wr_q_) {
+            CountPendingLine(it.first, 1);
+        }
+    }
+    ckpt.Field(return_queue_);
+    ckpt.Field(act_queue_);
+    ckpt.Field(last_trans_clk_);
+    ckpt.Field(last_rw_cmd_valid_);
+    ckpt.Field(last_rw_cmd_is_write_);
+    ckpt.Field(last_cas_rank_);
+    ckpt.Field(last_cas_bankgroup_);
+    ckpt.Field(write_draining_);
+    ckpt.Field(write_drain_rank_);
+    ckpt.Field(num_cmds_issued_);
+    ckpt.Field(dropped_prefetches_);
+    ckpt.Block(qos_arbiter_.Enabled() ? "qos" : "",
+               [&] { qos_arbiter_.Serialize(ckpt); });
+    // source limits are only restored if this run set them up as well
+    ckpt.Block(bw_regulator_ ? "bw_regulator" : "",
+               [&] { bw_regulator_->Serialize(ckpt); });
+    ckpt.Block(UseProactivePrecharge() ? "proactive_pre" : "", [&] {
+        ckpt.Field(proactive_confidence_);
+        ckpt.Field(proactive_closed_row_);
+        ckpt.Field(proactive_bank_idx_);
+    });
+    ckpt.Block(next_row_predictor_ ? "speculative_act" : "", [&] {
+        next_row_predictor_->Serialize(ckpt);
+        ckpt.Field(spec_row_);
+        ckpt.Field(spec_act_clk_);
+        ckpt.Field(spec_armed_);
+        ckpt.Field(spec_bank_idx_);
+    });
+    ckpt.Block(config_.row_prefetch_enabled ? "row_prefetch" : "", [&] {
+        ckpt.Field(row_prefetch_buf_);
+        ckpt.Field(row_prefetch_src_);
+        ckpt.Field(row_prefetch_next_);
+        ckpt.Field(row_prefetch_bank_idx_);
+    });
+}
+
 void Controller::PrintEpochStats() {
     simple_stats_.Increment("epoch_num");
     simple_stats_.PrintEpochStats();
@@ -502,16 +1307,41 @@ void Controller::PrintFinalStats() {
 }
 
 void Controller::UpdateCommandStats(const Command &cmd) {
+    if (cmd.IsReadWrite()) {
+        // back-to-back CAS in the same rank pay tCCD_L within a bank group
+        // and tCCD_S across bank groups
+        if (cmd.Rank() == last_cas_rank_) {
+            if (cmd.Bankgroup() == last_cas_bankgroup_) {
+                simple_stats_.Increment("num_cas_pairs_tccd_l");
+            } else {
+                simple_stats_.Increment("num_cas_pairs_tccd_s");
+            }
+        }
+        last_cas_rank_ = cmd.Rank();
+        last_cas_bankgroup_ = cmd.Bankgroup();
+        if (!issuing_row_prefetch_) {
+            simple_stats_.IncrementVec("source_cas_cmds", cmd.source_id);
+            if (bw_regulator_) {
+                bw_regulator_->OnCAS(cmd.source_id);
+            }
+        }
+    }
     switch (cmd.cmd_type) {
         case CommandType::READ:
         case CommandType::READ_PRECHARGE:
             simple_stats_.Increment("num_read_cmds");
-            if (channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(),
+            if (cmd.is_prefetch) {
+                simple_stats_.Increment("num_prefetch_cmds");
+            }
+            // row prefetches would inflate the demand row hit rate
+            if (!issuing_row_prefetch_ &&
+                channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(),
                                            cmd.Bank()) != 0) {
                 simple_stats_.Increment("num_read_row_hits");
-#ifdef ENABLE_EPOCH_STATS
-                ::dramsim3_epoch_row_hits++;
-#endif
+                if (cmd.is_prefetch) {
+                    simple_stats_.Increment("num_prefetch_row_hits");
+                }
+                epoch_row_hits_++;
             }
             // track bus turnaround: W->R
             if (last_rw_cmd_valid_ && last_rw_cmd_is_write_) {
@@ -526,9 +1356,7 @@ void Controller::UpdateCommandStats(const Command &cmd) {
             if (channel_state_.RowHitCount(cmd.Rank(), cmd.Bankgroup(),
                                            cmd.Bank()) != 0) {
                 simple_stats_.Increment("num_write_row_hits");
-#ifdef ENABLE_EPOCH_STATS
-                ::dramsim3_epoch_row_hits++;
-#endif
+                epoch_row_hits_++;
             }
             // track bus turnaround: R->W
             if (last_rw_cmd_valid_ && !last_rw_cmd_is_write_) {
@@ -539,9 +1367,7 @@ void Controller::UpdateCommandStats(const Command &cmd) {
             break;
         case CommandType::ACTIVATE:
             simple_stats_.Increment("num_act_cmds");
-#ifdef ENABLE_EPOCH_STATS
-            ::dramsim3_epoch_row_misses++;
-#endif
+            epoch_row_misses_++;
             break;
         case CommandType::PRECHARGE:
             simple_stats_.Increment("num_pre_cmds");
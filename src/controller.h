@@ -1,14 +1,21 @@
 #ifndef __CONTROLLER_H
 #define __CONTROLLER_H
 
+#include <deque>
 #include <fstream>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include "channel_state.h"
 #include "command_queue.h"
 #include "common.h"
+#include "bandwidth_regulator.h"
+#include "next_row_predictor.h"
+#include "qos_arbiter.h"
 #include "refresh.h"
+#include "row_activity_tracker.h"
 #include "simple_stats.h"
 
 #ifdef THERMAL
@@ -28,28 +35,69 @@ class Controller {
 #endif  // THERMAL
     void ClockTick();
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const;
+    // also refuses sources that are over their bandwidth limit
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               int source_id) const;
+    void SetSourceBandwidth(int source_id, double limit, double reservation);
     bool AddTransaction(Transaction trans);
+    // functional warmup, applies trans to the open rows, row tracking and
+    // page policy state as if served cycle cycles into the warmed span,
+    // without timing or stats
+    void WarmTransaction(const Transaction &trans, uint64_t cycle);
+    // the warmed span is over after cycles, clk_ stands still
+    void EndWarmup(uint64_t cycles);
     int QueueUsage() const;
     // Stats output
     void PrintEpochStats();
     void PrintFinalStats();
     void ResetStats() { simple_stats_.Reset(); }
-    std::pair<uint64_t, int> ReturnDoneTrans(uint64_t clock);
+    void BeginSampleWindow() { simple_stats_.BeginSampleWindow(); }
+    void EndSampleWindow() { simple_stats_.EndSampleWindow(); }
+    void GetStatsSnapshot(ChannelStatsSnapshot &snap) const {
+        simple_stats_.Snapshot(snap);
+    }
+    void MergeHistogram(const std::string &name,
+                        LogLinearHistogram &histo) const {
+        simple_stats_.MergeHistogram(name, histo);
+    }
+    // row hits and misses (ACTs) since the last call, for the front end
+    void TakeEpochRowStats(uint64_t &row_hits, uint64_t &row_misses) {
+        row_hits += epoch_row_hits_;
+        row_misses += epoch_row_misses_;
+        epoch_row_hits_ = 0;
+        epoch_row_misses_ = 0;
+    }
+    void Serialize(Checkpoint &ckpt);
+    // next finished transaction in trans, returns 0 for a read, 1 for a
+    // write, 2 for a dropped prefetch and -1 if there is none
+    int ReturnDoneTrans(uint64_t clock, Transaction &trans);
     Address ReturnACT(uint64_t clock);
     const std::vector<Transaction>& read_queue() const { return read_queue_; }
     const std::vector<Transaction>& write_buffer() const { return write_buffer_; }
+    // row activity of this channel, banks indexed rank * banks + bank
+    const RowActivityTracker& row_tracker() const { return row_tracker_; }
     int channel_id_;
 
   // private:
     uint64_t clk_;
+    // cycles cut out by functional warmup, the row tracker and warmed page
+    // policy state run on clk_ + warm_cycles_
+    uint64_t warm_cycles_;
     const Config &config_;
     SimpleStats simple_stats_;
     ChannelState channel_state_;
     CommandQueue cmd_queue_;
     Refresh refresh_;
+    RowActivityTracker row_tracker_;
+    // demand accesses only feed row_tracker_ for the row hit distance stats,
+    // DYMPL's page hotness and the idle times of warmed timeout policies
+    bool track_rows_;
     // --- New: context flags for classifying PRE/ACT source ---
     bool issuing_refresh_seq_ = false;  // true only while issuing REF/REFB sequence (incl. precharges)
     bool issuing_sref_seq_    = false;  // true only while issuing SREF_ENTER/EXIT sequence (incl. precharges)
+    bool issuing_proactive_pre_ = false;  // true only while issuing an early PRE of the proactive engine
+    bool issuing_spec_seq_ = false;  // true only while issuing a speculative ACT or its timeout PRE
+    bool issuing_row_prefetch_ = false;  // true only while issuing a row prefetch READ
 
 #ifdef THERMAL
     ThermalCalculator &thermal_calc_;
@@ -61,9 +109,10 @@ class Controller {
     std::vector<Transaction> read_queue_;
     std::vector<Transaction> write_buffer_;
 
-    // transactions that are not completed, use map for convenience
-    std::multimap<uint64_t, Transaction> pending_rd_q_;
-    std::multimap<uint64_t, Transaction> pending_wr_q_;
+    // transactions that are not completed by address, reads to the same
+    // address are merged and complete together in arrival order
+    std::unordered_map<uint64_t, std::vector<Transaction>> pending_rd_q_;
+    std::unordered_map<uint64_t, Transaction> pending_wr_q_;
 
     // completed transactions
     std::vector<Transaction> return_queue_;
@@ -83,16 +132,92 @@ class Controller {
     // used to calculate inter-arrival latency
     uint64_t last_trans_clk_;
 
+    uint64_t epoch_row_hits_ = 0;
+    uint64_t epoch_row_misses_ = 0;
+
     // track last R/W command direction for bus turnaround counting
     bool last_rw_cmd_valid_ = false;
     bool last_rw_cmd_is_write_ = false;
+    // last CAS rank/bankgroup, for tCCD_L vs tCCD_S pair counting
+    int last_cas_rank_ = -1;
+    int last_cas_bankgroup_ = -1;
 
     // transaction queueing
     int write_draining_;
+    int write_drain_rank_;
     void ScheduleTransaction();
+    void UpdateWriteDrainState();
+    std::vector<Transaction>::iterator PickDrainWrite();
+    std::vector<Transaction>::iterator PickWrite(int rank);
+    std::vector<Transaction>::iterator PickIdleRankWrite();
+    int BusiestWriteRank() const;
+    std::vector<Transaction>::iterator PickTransaction(
+        std::vector<Transaction> &queue);
+    std::vector<Transaction>::iterator PickTransaction(
+        std::vector<Transaction> &queue, bool demand_only);
+    // transaction level QoS (qos_mode)
+    QoSArbiter qos_arbiter_;
+    std::vector<Transaction>::iterator PickQoSTransaction(
+        std::vector<Transaction> &queue, bool demand_only);
+
+    // per source bandwidth limits/reservations, null if none configured
+    std::unique_ptr<BandwidthRegulator> bw_regulator_;
+
+    // prefetches dropped after prefetch_drop_threshold, not yet reported
+    std::vector<Transaction> dropped_prefetches_;
+    void DropStalePrefetches();
+    bool IsRowHitCandidate(const Transaction &trans, const Address &addr) const;
     void IssueCommand(const Command &tmp_cmd);
     Command TransToCommand(const Transaction &trans) const;
     void UpdateCommandStats(const Command &cmd);
+
+    // proactive precharge engine (aggressive_precharging_enabled), closes
+    // idle rows with no pending hits while the command bus is free
+    std::vector<int> proactive_confidence_;  // per bank 2-bit counter
+    std::vector<int> proactive_closed_row_;  // row closed early, -1 if none
+    int proactive_bank_idx_ = 0;
+    bool UseProactivePrecharge() const;
+    void IssueProactivePrecharge();
+    void UpdateProactiveState(const Command &cmd);
+    // any_row checks the whole bank instead of the row of addr
+    bool HasPendingAccess(const Address &addr, bool any_row) const;
+    int BankIndex(int rank, int bankgroup, int bank) const;
+
+    // speculative activation engine (speculative_act_enabled), opens the
+    // predicted next row of idle closed banks while the command bus is free
+    std::unique_ptr<NextRowPredictor> next_row_predictor_;
+    std::vector<int> spec_row_;  // row opened speculatively, -1 if none
+    std::vector<uint64_t> spec_act_clk_;
+    std::vector<char> spec_armed_;  // one speculation per demand activation
+    int spec_bank_idx_ = 0;
+    uint64_t num_cmds_issued_ = 0;
+    void IssueSpeculativeCommand();
+    void UpdateSpeculativeState(const Command &cmd);
+
+    // row buffer locality prefetcher (row_prefetch_enabled), reads the next
+    // lines of the last demand read row while the command bus is idle and
+    // serves later reads from a small buffer
+    struct RowPrefetchEntry {
+        uint64_t addr;
+        uint64_t ready_clk;
+        bool used;
+    };
+    std::deque<RowPrefetchEntry> row_prefetch_buf_;
+    std::vector<Address> row_prefetch_src_;  // per bank, last demand read
+    std::vector<int> row_prefetch_next_;     // per bank, next line offset
+    int row_prefetch_bank_idx_ = 0;
+    void IssueRowPrefetch();
+    bool ServeFromRowPrefetch(Transaction &trans);
+    bool HasPendingLine(uint64_t line_addr) const;
+    // pending_rd_q_ and pending_wr_q_ addresses per line, counted only with
+    // row prefetch on
+    std::unordered_map<uint64_t, int> pending_lines_;
+    void CountPendingLine(uint64_t hex_addr, int delta);
+    // address with unmapped bits cleared, as the buffer stores it
+    uint64_t LineAddress(uint64_t hex_addr) const {
+        return config_.GetHexAddress(config_.AddressMapping(hex_addr));
+    }
+    void InvalidateRowPrefetch(uint64_t hex_addr);
 };
 }  // namespace dramsim3
 #endif
@@ -1,11 +1,84 @@
 #include "cpu.h"
+#include "checkpoint.h"
 
 namespace dramsim3 {
 
+void CPU::StartPipeline() {
+    done_ring_.reset(new SPSCRing<ReadDone>(PIPELINE_RING_SIZE));
+    stop_helper_ = false;
+    helper_ = std::thread([this] {
+        while (true) {
+            // everything pushed before the stop is visible after it
+            bool stop = stop_helper_.load(std::memory_order_acquire);
+            bool busy = false;
+            ReadDone done;
+            while (done_ring_->TryPop(done)) {
+                PrintReadDone(done.addr, done.clk);
+                busy = true;
+            }
+            if (stop && !busy) {
+                return;
+            }
+            busy = Produce() || busy;
+            if (!busy) {
+                std::this_thread::yield();
+            }
+        }
+    });
+}
+
+void CPU::StopPipeline() {
+    if (!helper_.joinable()) {
+        return;
+    }
+    stop_helper_.store(true, std::memory_order_release);
+    helper_.join();
+    done_ring_.reset();
+}
+
+void CPU::SaveCheckpoint(const std::string& file_name) {
+    memory_system_.Save(file_name, CheckpointKey(),
+                        [this](Checkpoint& ckpt) { Serialize(ckpt); });
+}
+
+void CPU::RestoreCheckpoint(const std::string& file_name) {
+    bool restored = false;
+    memory_system_.Restore(file_name, CheckpointKey(),
+                           [&](Checkpoint& ckpt) {
+                               Serialize(ckpt);
+                               restored = true;
+                           });
+    if (!restored) {
+        std::cerr << "Checkpoint " << file_name << " was not saved by a "
+                  << CheckpointKey() << " CPU, starting it from cycle 0"
+                  << std::endl;
+    }
+}
+
+void CPU::Serialize(Checkpoint& ckpt) { ckpt.Field(clk_); }
+
+void CPU::ReadCallBack(uint64_t addr) {
+    if (!done_ring_) {
+        PrintReadDone(addr, clk_);
+        return;
+    }
+    while (!done_ring_->TryPush({addr, clk_})) {
+        std::this_thread::yield();
+    }
+}
+
+void CPU::PrintReadDone(uint64_t addr, uint64_t clk) const {
+    std::cout << "Rd complete for " << std::hex << std::setw(16)
+              << std::setfill('0') << addr << std::dec << " at clk " << clk
+              << std::endl;
+}
+
 void RandomCPU::ClockTick() {
     // Create random CPU requests at full speed
     // this is useful to exploit the parallelism of a DRAM protocol
     // and is also immune to address mapping and scheduling policies
+    // nothing to drop when sampling, the generator has no notion of time
+    clk_ += memory_system_.SampleSkipCycles();
     memory_system_.ClockTick();
     if (get_next_) {
         last_addr_ = gen();
@@ -19,12 +92,21 @@ void RandomCPU::ClockTick() {
     return;
 }
 
+void RandomCPU::Serialize(Checkpoint& ckpt) {
+    CPU::Serialize(ckpt);
+    ckpt.Field(last_addr_);
+    ckpt.Field(last_write_);
+    ckpt.Field(gen);
+    ckpt.Field(get_next_);
+}
+
 void StreamCPU::ClockTick() {
     // stream-add, read 2 arrays, add them up to the third array
     // this is a very simple approximate but should be able to produce
-    // enough buffer hits
+    // enough buffer hits, each array is tagged as its own source
 
     // moving on to next set of arrays
+    clk_ += memory_system_.SampleSkipCycles();
     memory_system_.ClockTick();
     if (offset_ >= array_size_ || clk_ == 0) {
         addr_a_ = gen();
@@ -34,18 +116,18 @@ void StreamCPU::ClockTick() {
     }
 
     if (!inserted_a_ &&
-        memory_system_.WillAcceptTransaction(addr_a_ + offset_, false)) {
-        memory_system_.AddTransaction(addr_a_ + offset_, false);
+        memory_system_.WillAcceptTransaction(addr_a_ + offset_, false, 0)) {
+        memory_system_.AddTransaction(addr_a_ + offset_, false, 0);
         inserted_a_ = true;
     }
     if (!inserted_b_ &&
-        memory_system_.WillAcceptTransaction(addr_b_ + offset_, false)) {
-        memory_system_.AddTransaction(addr_b_ + offset_, false);
+        memory_system_.WillAcceptTransaction(addr_b_ + offset_, false, 1)) {
+        memory_system_.AddTransaction(addr_b_ + offset_, false, 1);
         inserted_b_ = true;
     }
     if (!inserted_c_ &&
-        memory_system_.WillAcceptTransaction(addr_c_ + offset_, true)) {
-        memory_system_.AddTransaction(addr_c_ + offset_, true);
+        memory_system_.WillAcceptTransaction(addr_c_ + offset_, true, 2)) {
+        memory_system_.AddTransaction(addr_c_ + offset_, true, 2);
         inserted_c_ = true;
     }
     // moving on to next element
@@ -59,10 +141,22 @@ void StreamCPU::ClockTick() {
     return;
 }
 
+void StreamCPU::Serialize(Checkpoint& ckpt) {
+    CPU::Serialize(ckpt);
+    ckpt.Field(addr_a_);
+    ckpt.Field(addr_b_);
+    ckpt.Field(addr_c_);
+    ckpt.Field(offset_);
+    ckpt.Field(gen);
+    ckpt.Field(inserted_a_);
+    ckpt.Field(inserted_b_);
+    ckpt.Field(inserted_c_);
+}
+
 TraceBasedCPU::TraceBasedCPU(const std::string& config_file,
                              const std::string& output_dir,
                              const std::string& trace_file)
-    : CPU(config_file, output_dir) {
+    : CPU(config_file, output_dir), trace_name_(trace_file) {
     trace_file_.open(trace_file);
     if (trace_file_.fail()) {
         std::cerr << "Trace file does not exist" << std::endl;
@@ -70,18 +164,109 @@ TraceBasedCPU::TraceBasedCPU(const std::string& config_file,
     }
 }
 
-void TraceBasedCPU::ClockTick() {
-    memory_system_.ClockTick();
-    if (!trace_file_.eof()) {
+void TraceBasedCPU::StartPipeline() {
+    // the helper thread parses on from the current trace position
+    ring_pos_ = trace_file_.tellg();
+    record_ring_.reset(new SPSCRing<TraceRecord>(PIPELINE_RING_SIZE));
+    CPU::StartPipeline();
+}
+
+bool TraceBasedCPU::Produce() {
+    if (parse_done_) {
+        return false;
+    }
+    if (!parsed_pending_) {
+        parsed_.valid = static_cast<bool>(trace_file_ >> parsed_.trans);
+        parsed_.pos = trace_file_.tellg();
+        parsed_pending_ = true;
+    }
+    if (!record_ring_->TryPush(parsed_)) {
+        return false;
+    }
+    parsed_pending_ = false;
+    parse_done_ = !parsed_.valid;
+    return true;
+}
+
+bool TraceBasedCPU::NextRecord(Transaction& trans) {
+    if (!record_ring_) {
+        return static_cast<bool>(trace_file_ >> trans);
+    }
+    TraceRecord rec;
+    while (!record_ring_->TryPop(rec)) {
+        std::this_thread::yield();
+    }
+    trans = rec.trans;
+    ring_pos_ = rec.pos;
+    return rec.valid;
+}
+
+void TraceBasedCPU::Serialize(Checkpoint& ckpt) {
+    CPU::Serialize(ckpt);
+    ckpt.Field(trans_);
+    ckpt.Field(get_next_);
+    ckpt.Field(trace_done_);
+    int64_t pos = record_ring_ ? ring_pos_
+                               : static_cast<int64_t>(trace_file_.tellg());
+    ckpt.Field(pos);
+    if (ckpt.Restoring() && !trace_done_) {
+        trace_file_.clear();
+        trace_file_.seekg(pos);
+    }
+}
+
+void TraceBasedCPU::Warmup(uint64_t cycles) {
+    // the memory clock stands still, so warmed time is cut out of the
+    // detailed run, which sees the open rows and learned policies as left
+    uint64_t start = clk_;
+    uint64_t end = clk_ + cycles;
+    while (!trace_done_) {
         if (get_next_) {
             get_next_ = false;
-            trace_file_ >> trans_;
+            if (!NextRecord(trans_)) {
+                trace_done_ = true;
+                break;
+            }
+        }
+        if (trans_.added_cycle >= end) {
+            break;
         }
+        // a record held back by a full queue counts from the span start
+        uint64_t offset =
+            trans_.added_cycle > start ? trans_.added_cycle - start : 0;
+        memory_system_.WarmTransaction(trans_.addr, trans_.is_write, offset);
+        get_next_ = true;
+    }
+    memory_system_.EndWarmup(cycles);
+    clk_ = end;
+}
+
+void TraceBasedCPU::Replay(uint64_t cycles, int threads) {
+    memory_system_.ReplayTrace(trace_name_, cycles, threads);
+    clk_ += cycles;
+}
+
+void TraceBasedCPU::ClockTick() {
+    uint64_t skip = memory_system_.SampleSkipCycles();
+    if (skip > 0) {
+        Warmup(skip);
+    }
+    memory_system_.ClockTick();
+    if (get_next_ && !trace_done_) {
+        get_next_ = false;
+        trace_done_ = !NextRecord(trans_);
+    }
+    if (!trace_done_) {
         if (trans_.added_cycle <= clk_) {
-            get_next_ = memory_system_.WillAcceptTransaction(trans_.addr,
-                                                             trans_.is_write);
-            if (get_next_) {
-                memory_system_.AddTransaction(trans_.addr, trans_.is_write);
+            get_next_ = memory_system_.WillAcceptTransaction(
+                trans_.addr, trans_.is_write, trans_.source_id);
+            if (get_next_ && trans_.is_prefetch) {
+                memory_system_.AddPrefetch(trans_.addr, trans_.source_id);
+            } else if (get_next_) {
+                memory_system_.AddTransaction(trans_.addr, trans_.is_write,
+                                              trans_.source_id,
+                                              trans_.qos_class,
+                                              trans_.deadline);
             }
         }
     }
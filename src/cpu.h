@@ -1,15 +1,22 @@
 #ifndef __CPU_H
 #define __CPU_H
 
+#include <atomic>
 #include <fstream>
 #include <iomanip>
 #include <functional>
+#include <memory>
 #include <random>
 #include <string>
+#include <thread>
 #include "memory_system.h"
+#include "spsc_ring.h"
 
 namespace dramsim3 {
 
+// records a pipelined CPU may run ahead of the memory by
+static constexpr size_t PIPELINE_RING_SIZE = 4096;
+
 class CPU {
    public:
     CPU(const std::string& config_file, const std::string& output_dir)
@@ -18,19 +25,45 @@ class CPU {
               std::bind(&CPU::ReadCallBack, this, std::placeholders::_1),
               std::bind(&CPU::WriteCallBack, this, std::placeholders::_1)),
           clk_(0) {}
+    virtual ~CPU() { StopPipeline(); }
     virtual void ClockTick() = 0;
-    void ReadCallBack(uint64_t addr) { 
-                std::cout << "Rd complete for "
-                  << std::hex << std::setw(16) << std::setfill('0') << addr
-                  << std::dec
-                  << " at clk " << clk_ << std::endl;
-    }
+    // moves the completion output (and trace parsing) to a helper thread
+    // that talks to the simulation through bounded rings, the simulated
+    // cycles and the output stay the same
+    virtual void StartPipeline();
+    void ReadCallBack(uint64_t addr);
     void WriteCallBack(uint64_t addr) { return; }
-    void PrintStats() { memory_system_.PrintStats(); }
+    void PrintStats() {
+        StopPipeline();
+        memory_system_.PrintStats();
+    }
+    void ResetStats() { memory_system_.ResetStats(); }
+    uint64_t GetClk() const { return clk_; }
+    // the memory state plus the CPU clock and request generator, so a
+    // restored run carries on where the saved one stopped
+    void SaveCheckpoint(const std::string& file_name);
+    void RestoreCheckpoint(const std::string& file_name);
 
    protected:
+    // restored only into a CPU of the same kind
+    virtual std::string CheckpointKey() const = 0;
+    virtual void Serialize(Checkpoint& ckpt);
+    // helper thread work besides the output, true if it made progress
+    virtual bool Produce() { return false; }
+    // drains the output and joins the helper thread
+    void StopPipeline();
     MemorySystem memory_system_;
     uint64_t clk_;
+
+   private:
+    struct ReadDone {
+        uint64_t addr;
+        uint64_t clk;
+    };
+    void PrintReadDone(uint64_t addr, uint64_t clk) const;
+    std::unique_ptr<SPSCRing<ReadDone>> done_ring_;
+    std::atomic<bool> stop_helper_;
+    std::thread helper_;
 };
 
 class RandomCPU : public CPU {
@@ -38,6 +71,10 @@ class RandomCPU : public CPU {
     using CPU::CPU;
     void ClockTick() override;
 
+   protected:
+    std::string CheckpointKey() const override { return "random"; }
+    void Serialize(Checkpoint& ckpt) override;
+
    private:
     uint64_t last_addr_;
     bool last_write_ = false;
@@ -50,6 +87,10 @@ class StreamCPU : public CPU {
     using CPU::CPU;
     void ClockTick() override;
 
+   protected:
+    std::string CheckpointKey() const override { return "stream"; }
+    void Serialize(Checkpoint& ckpt) override;
+
    private:
     uint64_t addr_a_, addr_b_, addr_c_, offset_ = 0;
     std::mt19937_64 gen;
@@ -64,13 +105,49 @@ class TraceBasedCPU : public CPU {
    public:
     TraceBasedCPU(const std::string& config_file, const std::string& output_dir,
                   const std::string& trace_file);
-    ~TraceBasedCPU() { trace_file_.close(); }
+    ~TraceBasedCPU() {
+        StopPipeline();
+        trace_file_.close();
+    }
     void ClockTick() override;
+    // functionally applies the requests of the next cycles to the memory
+    // state, used for --warmup and between sampled windows
+    void Warmup(uint64_t cycles);
+    void StartPipeline() override;
+    // open-loop replay of the whole trace with the channels on threads
+    // workers instead of ticking it through ClockTick
+    void Replay(uint64_t cycles, int threads);
+
+   protected:
+    bool Produce() override;
+    std::string CheckpointKey() const override { return "trace"; }
+    // saves the read position of the trace and seeks back to it
+    void Serialize(Checkpoint& ckpt) override;
 
    private:
+    // next trace record, parsed here or taken from the helper thread,
+    // false once the trace is exhausted
+    bool NextRecord(Transaction& trans);
+
+    std::string trace_name_;
     std::ifstream trace_file_;
     Transaction trans_;
     bool get_next_ = true;
+    bool trace_done_ = false;
+
+    // pipelined mode, records parsed ahead by the helper thread
+    struct TraceRecord {
+        Transaction trans;
+        bool valid;
+        int64_t pos;  // trace offset after the record
+    };
+    std::unique_ptr<SPSCRing<TraceRecord>> record_ring_;
+    // trace offset after the last record taken from the ring, the file
+    // itself is read ahead by the helper thread
+    int64_t ring_pos_ = 0;
+    TraceRecord parsed_;
+    bool parsed_pending_ = false;
+    bool parse_done_ = false;
 };
 
 }  // namespace dramsim3
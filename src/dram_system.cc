@@ -1,18 +1,19 @@
 #include "dram_system.h"
 
 #include <assert.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace dramsim3 {
 
-// alternative way is to assign the id in constructor but this is less
-// destructive
-int BaseDRAMSystem::total_channels_ = 0;
-
 BaseDRAMSystem::BaseDRAMSystem(Config &config, const std::string &output_dir,
                                std::function<void(uint64_t)> read_callback,
                                std::function<void(uint64_t)> write_callback)
     : read_callback_(read_callback),
       write_callback_(write_callback),
+      batched_completions_(false),
       last_req_clk_(0),
       config_(config),
       timing_(config_),
@@ -20,8 +21,6 @@ BaseDRAMSystem::BaseDRAMSystem(Config &config, const std::string &output_dir,
       thermal_calc_(config_),
 #endif  // THERMAL
       clk_(0) {
-    total_channels_ += config_.channels;
-
 #ifdef ADDR_TRACE
     std::string addr_trace_name = config_.output_prefix + "addr.trace";
     address_trace_.open(addr_trace_name);
@@ -85,6 +84,132 @@ void BaseDRAMSystem::ResetStats() {
     }
 }
 
+void BaseDRAMSystem::BeginSampleWindow() {
+    for (size_t i = 0; i < ctrls_.size(); i++) {
+        ctrls_[i]->BeginSampleWindow();
+    }
+}
+
+void BaseDRAMSystem::EndSampleWindow() {
+    for (size_t i = 0; i < ctrls_.size(); i++) {
+        ctrls_[i]->EndSampleWindow();
+    }
+}
+
+void BaseDRAMSystem::TakeCompletions(std::vector<MemCompletion> &done) {
+    done.clear();
+    done.swap(completions_);
+}
+
+void BaseDRAMSystem::RegisterCompletionCallback(
+    std::function<void(const MemCompletion &)> completion_callback) {
+    completion_callback_ = completion_callback;
+}
+
+void BaseDRAMSystem::Complete(const Transaction &trans, int type) {
+    if (batched_completions_) {
+        completions_.push_back(
+            {trans.addr, trans.id, trans.meta, type == 1, type == 2});
+    } else if (completion_callback_) {
+        completion_callback_(
+            {trans.addr, trans.id, trans.meta, type == 1, type == 2});
+    } else if (type == 1) {
+        write_callback_(trans.addr);
+    } else if (type == 2 && prefetch_drop_callback_) {
+        prefetch_drop_callback_(trans.addr);
+    } else {
+        read_callback_(trans.addr);
+    }
+}
+
+size_t BaseDRAMSystem::AddTransactions(const MemRequest *requests,
+                                       size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const auto &req = requests[i];
+        if (!WillAcceptTransaction(req.addr, req.is_write, req.source_id)) {
+            return i;
+        }
+        if (req.is_prefetch && !req.is_write) {
+            AddPrefetch(req.addr, req.source_id);
+        } else {
+            AddTransaction(req.addr, req.is_write, req.source_id,
+                           req.qos_class, req.deadline);
+        }
+    }
+    return count;
+}
+
+void BaseDRAMSystem::ReplayTrace(const std::string &trace_file,
+                                 uint64_t cycles, int threads) {
+    std::cerr << "Sharded trace replay needs a JEDEC memory system"
+              << std::endl;
+    AbruptExit(__FILE__, __LINE__);
+}
+
+void BaseDRAMSystem::GetStatsSnapshot(StatsSnapshot &snap) const {
+    snap.version = STATS_SNAPSHOT_VERSION;
+    snap.cycle = clk_;
+    snap.channels.resize(ctrls_.size());
+    snap.average_bandwidth = 0.0;
+    snap.average_power = 0.0;
+    uint64_t reads = 0, cas = 0, hits = 0;
+    double latency_sum = 0.0;
+    LogLinearHistogram read_latency;
+    for (size_t i = 0; i < ctrls_.size(); i++) {
+        auto &chan = snap.channels[i];
+        ctrls_[i]->GetStatsSnapshot(chan);
+        ctrls_[i]->MergeHistogram("read_latency", read_latency);
+        snap.average_bandwidth += chan.average_bandwidth;
+        snap.average_power += chan.average_power;
+        uint64_t chan_reads = chan.counters["num_reads_done"];
+        reads += chan_reads;
+        latency_sum += chan.average_read_latency * chan_reads;
+        cas += chan.counters["num_read_cmds"] + chan.counters["num_write_cmds"] -
+               chan.counters["num_row_prefetch_reads"];
+        hits += chan.counters["num_read_row_hits"] +
+                chan.counters["num_write_row_hits"];
+    }
+    snap.average_read_latency = reads == 0 ? 0.0 : latency_sum / reads;
+    snap.read_latency_p50 = read_latency.Percentile(0.5);
+    snap.read_latency_p99 = read_latency.Percentile(0.99);
+    snap.read_latency_p999 = read_latency.Percentile(0.999);
+    snap.read_latency_p9999 = read_latency.Percentile(0.9999);
+    snap.row_hit_rate = cas == 0 ? 0.0 : static_cast<double>(hits) / cas;
+}
+
+void BaseDRAMSystem::TakeEpochRowStats(uint64_t &row_hits,
+                                       uint64_t &row_misses) {
+    row_hits = 0;
+    row_misses = 0;
+    for (size_t i = 0; i < ctrls_.size(); i++) {
+        ctrls_[i]->TakeEpochRowStats(row_hits, row_misses);
+    }
+}
+
+void BaseDRAMSystem::Serialize(Checkpoint &ckpt) {
+    // channels, banks and queues must line up, timings and policies may not
+    ckpt.Expect("organization",
+                std::to_string(config_.channels) + "ch " +
+                    std::to_string(config_.ranks) + "ra " +
+                    std::to_string(config_.bankgroups) + "bg " +
+                    std::to_string(config_.banks_per_group) + "ba " +
+                    std::to_string(config_.rows) + "ro " +
+                    std::to_string(config_.columns) + "co " +
+                    config_.queue_structure +
+                    (config_.unified_queue ? " unified" : ""));
+    ckpt.Field(clk_);
+    ckpt.Field(last_req_clk_);
+    ckpt.Field(completions_);
+    for (size_t i = 0; i < ctrls_.size(); i++) {
+        ctrls_[i]->Serialize(ckpt);
+    }
+    // epoch output restarts mid-run, open the list the first epoch would
+    if (ckpt.Restoring() && clk_ >= static_cast<uint64_t>(config_.epoch_period)) {
+        std::ofstream epoch_out(config_.json_epoch_name, std::ofstream::out);
+        epoch_out << "[";
+    }
+}
+
 void BaseDRAMSystem::RegisterCallbacks(
     std::function<void(uint64_t)> read_callback,
     std::function<void(uint64_t)> write_callback) {
@@ -101,6 +226,18 @@ void BaseDRAMSystem::RegisterACTCallback(
     act_callback_ = act_callback;
 }
 
+void BaseDRAMSystem::SetSourceBandwidth(int source_id, double limit,
+                                        double reservation) {
+    for (auto ctrl : ctrls_) {
+        ctrl->SetSourceBandwidth(source_id, limit, reservation);
+    }
+}
+
+void BaseDRAMSystem::RegisterPrefetchDropCallback(
+    std::function<void(uint64_t)> prefetch_drop_callback) {
+    prefetch_drop_callback_ = prefetch_drop_callback;
+}
+
 JedecDRAMSystem::JedecDRAMSystem(Config &config, const std::string &output_dir,
                                  std::function<void(uint64_t)> read_callback,
                                  std::function<void(uint64_t)> write_callback)
@@ -119,10 +256,6 @@ JedecDRAMSystem::JedecDRAMSystem(Config &config, const std::string &output_dir,
         ctrls_.push_back(new Controller(i, config_, timing_));
 #endif  // THERMAL
     }
-
-    // Initialize row history for all banks across all channels
-    int total_banks = config_.channels * config_.ranks * config_.banks;
-    row_history_.resize(total_banks);
 }
 
 JedecDRAMSystem::~JedecDRAMSystem() {
@@ -137,7 +270,83 @@ bool JedecDRAMSystem::WillAcceptTransaction(uint64_t hex_addr,
     return ctrls_[channel]->WillAcceptTransaction(hex_addr, is_write);
 }
 
+bool JedecDRAMSystem::WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                            int source_id) const {
+    int channel = GetChannel(hex_addr);
+    return ctrls_[channel]->WillAcceptTransaction(hex_addr, is_write,
+                                                  source_id);
+}
+
 bool JedecDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write) {
+    return AddTransaction(hex_addr, is_write, 0);
+}
+
+bool JedecDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write,
+                                     int source_id) {
+    return AddTransaction(hex_addr, is_write, source_id, 0, 0);
+}
+
+bool JedecDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write,
+                                     int source_id, int qos_class,
+                                     uint64_t deadline) {
+    Transaction trans = Transaction(hex_addr, is_write);
+    trans.source_id = source_id;
+    trans.qos_class = qos_class;
+    trans.deadline = deadline;
+    return EnqueueTransaction(trans);
+}
+
+bool JedecDRAMSystem::AddPrefetch(uint64_t hex_addr, int source_id) {
+    Transaction trans = Transaction(hex_addr, false);
+    trans.source_id = source_id;
+    trans.is_prefetch = true;
+    return EnqueueTransaction(trans);
+}
+
+size_t JedecDRAMSystem::AddTransactions(const MemRequest *requests,
+                                        size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const auto &req = requests[i];
+        auto ctrl = ctrls_[GetChannel(req.addr)];
+        if (!ctrl->WillAcceptTransaction(req.addr, req.is_write,
+                                         req.source_id)) {
+            return i;
+        }
+#ifdef ADDR_TRACE
+        address_trace_ << std::hex << req.addr << std::dec << " "
+                       << (req.is_write ? "WRITE " : "READ ") << clk_
+                       << std::endl;
+#endif
+        Transaction trans(req.addr, req.is_write);
+        trans.id = req.id;
+        trans.meta = req.meta;
+        trans.source_id = req.source_id;
+        trans.is_prefetch = req.is_prefetch && !req.is_write;
+        if (!trans.is_prefetch) {
+            trans.qos_class = req.qos_class;
+            trans.deadline = req.deadline;
+        }
+        ctrl->AddTransaction(trans);
+        last_req_clk_ = clk_;
+    }
+    return count;
+}
+
+void JedecDRAMSystem::WarmTransaction(uint64_t hex_addr, bool is_write,
+                                      uint64_t cycle) {
+    int channel = GetChannel(hex_addr);
+    ctrls_[channel]->WarmTransaction(Transaction(hex_addr, is_write), cycle);
+}
+
+void JedecDRAMSystem::EndWarmup(uint64_t cycles) {
+    for (size_t i = 0; i < ctrls_.size(); i++) {
+        ctrls_[i]->EndWarmup(cycles);
+    }
+}
+
+bool JedecDRAMSystem::EnqueueTransaction(Transaction trans) {
+    uint64_t hex_addr = trans.addr;
+    bool is_write = trans.is_write;
 // Record trace - Record address trace for debugging or other purposes
 #ifdef ADDR_TRACE
     address_trace_ << std::hex << hex_addr << std::dec << " "
@@ -149,25 +358,6 @@ bool JedecDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write) {
 
     assert(ok);
     if (ok) {
-        // Row hit distance statistics
-        Address addr = config_.AddressMapping(hex_addr);
-        int bank_idx = GetBankIndex(channel, addr.rank, addr.bankgroup, addr.bank);
-        int current_row = addr.row;
-
-        // Check for row hits in history
-        auto& history = row_history_[bank_idx];
-        for (size_t i = 0; i < history.count; i++) {
-            const auto& record = history.records[i];
-            if (record.row == current_row) {
-                int distance = static_cast<int>(clk_ - record.timestamp);
-                row_hit_distance_histogram_[distance]++;
-            }
-        }
-
-        // Record current access
-        RecordRowAccess(bank_idx, current_row, clk_);
-
-        Transaction trans = Transaction(hex_addr, is_write);
         ctrls_[channel]->AddTransaction(trans);
     }
     last_req_clk_ = clk_;
@@ -177,15 +367,10 @@ bool JedecDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write) {
 void JedecDRAMSystem::ClockTick() {
     for (size_t i = 0; i < ctrls_.size(); i++) {
         // look ahead and return earlier
-        while (true) {
-            auto pair = ctrls_[i]->ReturnDoneTrans(clk_);
-            if (pair.second == 1) {
-                write_callback_(pair.first);
-            } else if (pair.second == 0) {
-                read_callback_(pair.first);
-            } else {
-                break;
-            }
+        Transaction trans;
+        int type;
+        while ((type = ctrls_[i]->ReturnDoneTrans(clk_, trans)) >= 0) {
+            Complete(trans, type);
         }
        // while (true) {
        //     auto actAddr = ctrls_[i]->ReturnACT(clk_);
@@ -209,94 +394,127 @@ void JedecDRAMSystem::ClockTick() {
     return;
 }
 
-void JedecDRAMSystem::PrintStats() {
-    // Call base class PrintStats
-    BaseDRAMSystem::PrintStats();
-    // Append row hit distance statistics
-    PrintRowHitDistanceStats();
-}
-
-int JedecDRAMSystem::GetBankIndex(int channel, int rank, int bankgroup, int bank) const {
-    return channel * (config_.ranks * config_.banks) +
-           rank * config_.banks +
-           bankgroup * config_.banks_per_group + bank;
-}
+void JedecDRAMSystem::ReplayTrace(const std::string &trace_file,
+                                  uint64_t cycles, int threads) {
+    std::ifstream trace(trace_file);
+    if (trace.fail()) {
+        std::cerr << "Trace file does not exist" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    // trace cycles count from the start of the replay, as the trace CPU's
+    uint64_t start = clk_;
+    uint64_t end = clk_ + cycles;
+    std::vector<std::deque<Transaction>> streams(ctrls_.size());
+    Transaction next;
+    bool has_next = static_cast<bool>(trace >> next);
+
+    int workers = threads > 0 ? threads : std::thread::hardware_concurrency();
+#ifdef THERMAL
+    workers = 1;  // the thermal model is shared by all channels
+#endif  // THERMAL
+    workers = std::max(1, std::min(workers, static_cast<int>(ctrls_.size())));
+    // workers wait for a new generation, run their channels up to stop and
+    // report back, worker 0 is this thread
+    std::mutex mutex;
+    std::condition_variable start_cv, done_cv;
+    uint64_t generation = 0;
+    uint64_t stop = clk_;
+    int running = 0;
+    bool quit = false;
+    auto work = [&](int worker) {
+        for (size_t i = worker; i < ctrls_.size(); i += workers) {
+            ReplayChannel(i, streams[i], start, stop);
+        }
+    };
+    auto loop = [&](int worker) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start_cv.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+                if (quit) {
+                    return;
+                }
+            }
+            work(worker);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0) {
+                done_cv.notify_one();
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int w = 1; w < workers; w++) {
+        pool.emplace_back(loop, w);
+    }
 
-void JedecDRAMSystem::RecordRowAccess(int bank_idx, int row, uint64_t timestamp) {
-    auto& history = row_history_[bank_idx];
-    
-    // Check if this row already exists in history, if so just update timestamp
-    for (size_t i = 0; i < history.count; i++) {
-        if (history.records[i].row == row) {
-            history.records[i].timestamp = timestamp;
-            return;
+    while (clk_ < end) {
+        // epoch stats are printed for all channels at once
+        stop = std::min({end, clk_ + REPLAY_CHUNK_CYCLES,
+                         (clk_ / config_.epoch_period + 1) *
+                             config_.epoch_period});
+        while (has_next && next.added_cycle < stop - start) {
+            streams[GetChannel(next.addr)].push_back(next);
+            has_next = static_cast<bool>(trace >> next);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = workers - 1;
+            generation++;
+        }
+        start_cv.notify_all();
+        work(0);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done_cv.wait(lock, [&] { return running == 0; });
+        }
+        clk_ = stop;
+        if (clk_ % config_.epoch_period == 0) {
+            PrintEpochStats();
         }
     }
-    
-    // Row not found, add new entry
-    history.records[history.head] = {row, timestamp};
-    history.head = (history.head + 1) % MAX_ROW_HISTORY;
-    if (history.count < MAX_ROW_HISTORY) {
-        history.count++;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        generation++;
     }
+    start_cv.notify_all();
+    for (auto &thread : pool) {
+        thread.join();
+    }
+    last_req_clk_ = clk_;
 }
 
-void JedecDRAMSystem::PrintRowHitDistanceStats() const {
-    std::ofstream out(config_.txt_stats_name, std::ofstream::app);
-    out << "\n###########################################\n";
-    out << "## Row Hit Distance Distribution\n";
-    out << "###########################################\n";
-
-    // Use a capped, non-uniform binning based on timing constraints.
-    int max_distance = config_.tREFI;
-    if (max_distance <= 0) {
-        max_distance = 10000;
-    }
-    int base_bin = std::max(8, config_.tCCD_S * 2);
-
-    std::vector<std::pair<int, int>> bins;
-    int start = 0;
-    int width = base_bin;
-    while (start < max_distance) {
-        int end = start + width - 1;
-        if (end >= max_distance) {
-            end = max_distance - 1;
+void JedecDRAMSystem::ReplayChannel(int channel,
+                                    std::deque<Transaction> &stream,
+                                    uint64_t start, uint64_t end) {
+    // the per cycle order of ClockTick and TraceBasedCPU, a channel takes
+    // at most one request per cycle and only blocks its own stream
+    auto ctrl = ctrls_[channel];
+    Transaction done;
+    for (uint64_t clk = clk_; clk < end; clk++) {
+        while (ctrl->ReturnDoneTrans(clk, done) >= 0) {
         }
-        bins.emplace_back(start, end);
-        start = end + 1;
-        if (start >= max_distance) {
-            break;
+        ctrl->ClockTick();
+        if (stream.empty() || stream.front().added_cycle > clk - start) {
+            continue;
         }
-        width *= 2;
-    }
-
-    std::vector<uint64_t> binned_counts(bins.size(), 0);
-    uint64_t overflow_count = 0;
-    for (const auto& pair : row_hit_distance_histogram_) {
-        int distance = pair.first;
-        uint64_t count = pair.second;
-        if (distance >= max_distance) {
-            overflow_count += count;
+        const auto &next = stream.front();
+        if (!ctrl->WillAcceptTransaction(next.addr, next.is_write,
+                                         next.source_id)) {
             continue;
         }
-        for (size_t i = 0; i < bins.size(); i++) {
-            if (distance >= bins[i].first && distance <= bins[i].second) {
-                binned_counts[i] += count;
-                break;
-            }
+        Transaction trans(next.addr, next.is_write);
+        trans.source_id = next.source_id;
+        trans.is_prefetch = next.is_prefetch;
+        if (!next.is_prefetch) {
+            trans.qos_class = next.qos_class;
+            trans.deadline = next.deadline;
         }
+        ctrl->AddTransaction(trans);
+        stream.pop_front();
     }
-
-    uint64_t total_hits = 0;
-    for (size_t i = 0; i < bins.size(); i++) {
-        out << "distance[" << bins[i].first << "-" << bins[i].second << "]: "
-            << binned_counts[i] << "\n";
-        total_hits += binned_counts[i];
-    }
-    out << "distance[>=" << max_distance << "]: " << overflow_count << "\n";
-    total_hits += overflow_count;
-    out << "total_row_hits: " << total_hits << "\n";
-    out.close();
 }
 
 IdealDRAMSystem::IdealDRAMSystem(Config &config, const std::string &output_dir,
@@ -314,15 +532,23 @@ bool IdealDRAMSystem::AddTransaction(uint64_t hex_addr, bool is_write) {
     return true;
 }
 
+size_t IdealDRAMSystem::AddTransactions(const MemRequest *requests,
+                                        size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        auto trans = Transaction(requests[i].addr, requests[i].is_write);
+        trans.added_cycle = clk_;
+        trans.id = requests[i].id;
+        trans.meta = requests[i].meta;
+        infinite_buffer_q_.push_back(trans);
+    }
+    return count;
+}
+
 void IdealDRAMSystem::ClockTick() {
     for (auto trans_it = infinite_buffer_q_.begin();
          trans_it != infinite_buffer_q_.end();) {
         if (clk_ - trans_it->added_cycle >= static_cast<uint64_t>(latency_)) {
-            if (trans_it->is_write) {
-                write_callback_(trans_it->addr);
-            } else {
-                read_callback_(trans_it->addr);
-            }
+            Complete(*trans_it, trans_it->is_write ? 1 : 0);
             trans_it = infinite_buffer_q_.erase(trans_it++);
         }
         if (trans_it != infinite_buffer_q_.end()) {
@@ -334,4 +560,9 @@ void IdealDRAMSystem::ClockTick() {
     return;
 }
 
+void IdealDRAMSystem::Serialize(Checkpoint &ckpt) {
+    BaseDRAMSystem::Serialize(ckpt);
+    ckpt.Field(infinite_buffer_q_);
+}
+
 }  // namespace dramsim3
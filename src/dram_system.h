@@ -1,7 +1,7 @@
 #ifndef __DRAM_SYSTEM_H
 #define __DRAM_SYSTEM_H
 
-#include <array>
+#include <deque>
 #include <fstream>
 #include <map>
 #include <string>
@@ -30,22 +30,71 @@ class BaseDRAMSystem {
                                                 uint64_t, 
                                                 uint64_t,
                                                 uint64_t)> act_callback);
+    void RegisterPrefetchDropCallback(
+        std::function<void(uint64_t)> prefetch_drop_callback);
+    void RegisterCompletionCallback(
+        std::function<void(const MemCompletion &)> completion_callback);
+    // completions are buffered for TakeCompletions instead of going
+    // through the callbacks
+    void SetBatchedCompletions(bool batched) { batched_completions_ = batched; }
+    void TakeCompletions(std::vector<MemCompletion> &done);
     void PrintEpochStats();
     virtual void PrintStats();
     void ResetStats();
+    void BeginSampleWindow();
+    void EndSampleWindow();
+    void TakeEpochRowStats(uint64_t &row_hits, uint64_t &row_misses);
+    void GetStatsSnapshot(StatsSnapshot &snap) const;
+    // walks the state of every channel for Save/Restore
+    virtual void Serialize(Checkpoint &ckpt);
 
     virtual bool WillAcceptTransaction(uint64_t hex_addr,
                                        bool is_write) const = 0;
+    virtual bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                       int source_id) const {
+        return WillAcceptTransaction(hex_addr, is_write);
+    }
+    void SetSourceBandwidth(int source_id, double limit, double reservation);
     virtual bool AddTransaction(uint64_t hex_addr, bool is_write) = 0;
+    // systems without requestor tracking simply drop the source id
+    virtual bool AddTransaction(uint64_t hex_addr, bool is_write,
+                                int source_id) {
+        return AddTransaction(hex_addr, is_write);
+    }
+    virtual bool AddTransaction(uint64_t hex_addr, bool is_write,
+                                int source_id, int qos_class,
+                                uint64_t deadline) {
+        return AddTransaction(hex_addr, is_write, source_id);
+    }
+    // systems without prefetch awareness treat it as a normal read
+    virtual bool AddPrefetch(uint64_t hex_addr, int source_id) {
+        return AddTransaction(hex_addr, false, source_id);
+    }
+    // systems without row buffers have nothing to warm
+    virtual void WarmTransaction(uint64_t hex_addr, bool is_write,
+                                 uint64_t cycle) {}
+    virtual void EndWarmup(uint64_t cycles) {}
+    // takes requests in order until one is refused, returns how many
+    virtual size_t AddTransactions(const MemRequest *requests, size_t count);
     virtual void ClockTick() = 0;
+    // channel sharded open-loop replay, see MemorySystem::ReplayTrace
+    virtual void ReplayTrace(const std::string &trace_file, uint64_t cycles,
+                             int threads);
     int GetChannel(uint64_t hex_addr) const;
 
     std::function<void(uint64_t req_id)> read_callback_, write_callback_;
     std::function<void(uint64_t ch, uint64_t ra, 
                     uint64_t ba, uint64_t ro)> act_callback_;
-    static int total_channels_;
+    std::function<void(uint64_t req_id)> prefetch_drop_callback_;
+    std::function<void(const MemCompletion &)> completion_callback_;
 
    protected:
+    // hands a finished transaction to the callbacks or the batch, type as
+    // returned by Controller::ReturnDoneTrans
+    void Complete(const Transaction &trans, int type);
+    bool batched_completions_;
+    std::vector<MemCompletion> completions_;
+
     uint64_t id_;
     uint64_t last_req_clk_;
     Config &config_;
@@ -65,6 +114,10 @@ class BaseDRAMSystem {
 #endif  // ADDR_TRACE
 };
 
+// trace records ReplayTrace holds at once are bounded by this many cycles
+// of input, the replay workers also meet at every chunk boundary
+static constexpr uint64_t REPLAY_CHUNK_CYCLES = 10000;
+
 // hmmm not sure this is the best naming...
 class JedecDRAMSystem : public BaseDRAMSystem {
    public:
@@ -73,27 +126,27 @@ class JedecDRAMSystem : public BaseDRAMSystem {
                     std::function<void(uint64_t)> write_callback);
     ~JedecDRAMSystem();
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const override;
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               int source_id) const override;
     bool AddTransaction(uint64_t hex_addr, bool is_write) override;
+    bool AddTransaction(uint64_t hex_addr, bool is_write,
+                        int source_id) override;
+    bool AddTransaction(uint64_t hex_addr, bool is_write, int source_id,
+                        int qos_class, uint64_t deadline) override;
+    bool AddPrefetch(uint64_t hex_addr, int source_id) override;
+    size_t AddTransactions(const MemRequest *requests, size_t count) override;
+    void WarmTransaction(uint64_t hex_addr, bool is_write,
+                         uint64_t cycle) override;
+    void EndWarmup(uint64_t cycles) override;
     void ClockTick() override;
-    void PrintStats() override;
+    void ReplayTrace(const std::string &trace_file, uint64_t cycles,
+                     int threads) override;
 
    private:
-    // Row hit distance statistics
-    static constexpr size_t MAX_ROW_HISTORY = 64;
-    struct RowAccessRecord {
-        int row;
-        uint64_t timestamp;
-    };
-    struct BankRowHistory {
-        std::array<RowAccessRecord, MAX_ROW_HISTORY> records;
-        size_t head = 0;   // next write position
-        size_t count = 0;  // valid record count
-    };
-    std::vector<BankRowHistory> row_history_;  // indexed by bank
-    std::map<int, uint64_t> row_hit_distance_histogram_;
-    int GetBankIndex(int channel, int rank, int bankgroup, int bank) const;
-    void RecordRowAccess(int bank_idx, int row, uint64_t timestamp);
-    void PrintRowHitDistanceStats() const;
+    bool EnqueueTransaction(Transaction trans);
+    // runs one channel from clk_ to end, issuing from the front of stream
+    void ReplayChannel(int channel, std::deque<Transaction> &stream,
+                       uint64_t start, uint64_t end);
 };
 
 // Model a memorysystem with an infinite bandwidth and a fixed latency (possibly
@@ -105,12 +158,16 @@ class IdealDRAMSystem : public BaseDRAMSystem {
                     std::function<void(uint64_t)> read_callback,
                     std::function<void(uint64_t)> write_callback);
     ~IdealDRAMSystem();
+    using BaseDRAMSystem::WillAcceptTransaction;
     bool WillAcceptTransaction(uint64_t hex_addr,
                                bool is_write) const override {
         return true;
     };
+    using BaseDRAMSystem::AddTransaction;
     bool AddTransaction(uint64_t hex_addr, bool is_write) override;
+    size_t AddTransactions(const MemRequest *requests, size_t count) override;
     void ClockTick() override;
+    void Serialize(Checkpoint &ckpt) override;
 
    private:
     int latency_;
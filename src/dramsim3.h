@@ -1,11 +1,79 @@
 #ifndef __MEMORY_SYSTEM__H
 #define __MEMORY_SYSTEM__H
 
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace dramsim3 {
 
+class Checkpoint;
+
+// a request submitted with MemorySystem::AddRequest or AddTransactions
+struct MemRequest {
+    uint64_t addr;
+    bool is_write;
+    uint64_t id;
+    uint64_t meta;
+    // as for AddTransaction and AddPrefetch, zero when left out of a brace
+    // initializer: source 0, the most critical QoS class, no deadline
+    int source_id;
+    int qos_class;
+    uint64_t deadline;  // latency budget in cycles
+    bool is_prefetch;   // reads only, qos_class and deadline are ignored
+};
+
+// a finished request, passed to the completion callback or collected
+// with MemorySystem::TakeCompletions
+struct MemCompletion {
+    uint64_t addr;
+    uint64_t id;
+    uint64_t meta;
+    bool is_write;
+    bool dropped;  // a prefetch dropped by prefetch_drop_threshold
+};
+
+// statistics of one channel since the start or the last ResetStats
+struct ChannelStatsSnapshot {
+    int channel;
+    std::map<std::string, uint64_t> counters;
+    std::map<std::string, std::vector<uint64_t>> vec_counters;
+    // log-linear histograms as lowest value of a bucket -> count, exact
+    // below 128, buckets are within 1/64 of their value above
+    std::map<std::string, std::map<int, uint64_t>> histograms;
+    double average_bandwidth;     // GB/s
+    double average_read_latency;  // cycles
+    double read_latency_p50;
+    double read_latency_p99;
+    double read_latency_p999;
+    double read_latency_p9999;
+    double row_hit_rate;          // row hits per READ/WRITE command
+    double total_energy;          // pJ
+    double average_power;         // mW
+};
+
+// bumped whenever the snapshot layout or the meaning of a field changes
+static constexpr uint32_t STATS_SNAPSHOT_VERSION = 2;
+
+// in memory stats of the whole system, see MemorySystem::GetStatsSnapshot
+struct StatsSnapshot {
+    uint32_t version;  // STATS_SNAPSHOT_VERSION
+    uint64_t cycle;  // memory cycles simulated
+    std::vector<ChannelStatsSnapshot> channels;
+    // over all channels, bandwidth and power are summed, percentiles come
+    // from the merged histograms
+    double average_bandwidth;
+    double average_read_latency;
+    double read_latency_p50;
+    double read_latency_p99;
+    double read_latency_p999;
+    double read_latency_p9999;
+    double row_hit_rate;
+    double average_power;
+};
+
 // This should be the interface class that deals with CPU
 class MemorySystem {
    public:
@@ -26,9 +94,75 @@ class MemorySystem {
     int GetQueueSize() const;
     void PrintStats() const;
     void ResetStats();
+    // complete simulator state as a versioned binary file, restore into a
+    // memory system with the same organization, callbacks are not saved.
+    // host walks the caller's own state (e.g. the CPU model) into a block
+    // keyed host_key, restored only by a caller passing the same key
+    void Save(const std::string &file_name, const std::string &host_key = "",
+              const std::function<void(Checkpoint &)> &host = nullptr);
+    void Restore(const std::string &file_name,
+                 const std::string &host_key = "",
+                 const std::function<void(Checkpoint &)> &host = nullptr);
 
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const;
+    // also refuses sources over their bandwidth limit
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               int source_id) const;
+    // bandwidth limit and reservation of a source as shares of the channel
+    // peak, applied to every channel, 0 for none
+    void SetSourceBandwidth(int source_id, double limit, double reservation);
     bool AddTransaction(uint64_t hex_addr, bool is_write);
+    // source_id tags the requestor for the fairness aware schedulers
+    bool AddTransaction(uint64_t hex_addr, bool is_write, int source_id);
+    // qos_class 0 is the most latency critical, deadline is a latency budget
+    // in DRAM cycles (0 for none), both are used when qos_mode is set
+    bool AddTransaction(uint64_t hex_addr, bool is_write, int source_id,
+                        int qos_class, uint64_t deadline);
+    // a prefetch read, completes through the read callback unless dropped
+    bool AddPrefetch(uint64_t hex_addr, int source_id);
+    // a single request with an id and metadata word, handed back through
+    // the completion callback
+    bool AddRequest(const MemRequest &request);
+    // called with the id and metadata of every finished request instead of
+    // the read and write callbacks
+    void RegisterCompletionCallback(
+        std::function<void(const MemCompletion &)> completion_callback);
+    // batched front end, requests are taken in order until one is refused
+    // and the number taken is returned, offer the rest on a later cycle
+    size_t AddTransactions(const MemRequest *requests, size_t count);
+    // buffer completions for TakeCompletions instead of calling the read
+    // and write callbacks per request
+    void SetBatchedCompletions(bool batched);
+    // replaces done with the completions buffered since the last call
+    void TakeCompletions(std::vector<MemCompletion> &done);
+    // functional warmup: applies an access made cycle cycles into the
+    // warmed span to the open rows and page policy state, without timing,
+    // stats or callbacks. EndWarmup closes a span of cycles, the memory clock
+    // stands still but later accesses see the warmed state that much older
+    void WarmTransaction(uint64_t hex_addr, bool is_write, uint64_t cycle);
+    void EndWarmup(uint64_t cycles);
+    // called for prefetches dropped by prefetch_drop_threshold, without it
+    // dropped prefetches are reported through the read callback
+    void RegisterPrefetchDropCallback(
+        std::function<void(uint64_t)> prefetch_drop_callback);
+    // sampled simulation (sample_window > 0): once a detailed window is
+    // measured, returns the cycles the front end should fast-forward its
+    // input by, the memory state is kept warm across the skip, 0 otherwise
+    uint64_t SampleSkipCycles();
+    // row buffer hits (READ/WRITE to an open row) and misses (ACT) of all
+    // channels since the last call, instance wide epoch counters
+    void TakeEpochRowStats(uint64_t &row_hits, uint64_t &row_misses);
+    // all counters, histograms and derived values at this cycle, without
+    // file output or side effects, counters only grow so consumers polling
+    // every epoch can diff two snapshots
+    StatsSnapshot GetStatsSnapshot() const;
+    // open-loop replay of a trace file for the next cycles: the records are
+    // split by channel and every channel runs its own stream on one of
+    // threads workers (0: one per core), the trace is read and the workers
+    // meet every REPLAY_CHUNK_CYCLES and at each epoch boundary, stats only,
+    // no callbacks
+    void ReplayTrace(const std::string &trace_file, uint64_t cycles,
+                     int threads);
 };
 
 MemorySystem* GetMemorySystem(const std::string &config_file, const std::string &output_dir,
@@ -103,7 +103,7 @@ int DYMPLPredictor::SatDecrement(int val, int min_val) {
     return val > min_val ? val - 1 : min_val;
 }
 
-bool DYMPLPredictor::Predict(int bank_id, int row, int col) {
+bool DYMPLPredictor::Predict(int bank_id, int row, int col, uint32_t hotness) {
     simple_stats_.Increment("dympl_predictions");
 
     PRTEntry* prt = FindPRTEntry(bank_id, row);
@@ -126,7 +126,8 @@ bool DYMPLPredictor::Predict(int bank_id, int row, int col) {
 
     // Compute feature indices
     int f_page_util = prt->utilization;                           // [0,15]
-    int f_page_hot = prt->hotness;                                // [0,31]
+    int f_page_hot = static_cast<int>(std::min<uint32_t>(
+        hotness, DYMPL_WT_PAGE_HOT_SIZE - 1));                    // [0,31]
     int f_page_rec = prt->recency;                                // [0,15]
     int f_col_stride = prt->stride;                               // [0,15]
     int f_page_hitcnt = prt->hit_count + 8;                       // [-8,+7] → [0,15]
@@ -186,9 +187,6 @@ void DYMPLPredictor::UpdateOnCAS(int bank_id, int row, int col, bool is_row_hit)
     // Update page utilization: sat-increment on CAS
     prt->utilization = SatIncrement(prt->utilization, 15);
 
-    // Update page hotness: sat-increment on CAS
-    prt->hotness = SatIncrement(prt->hotness, 31);
-
     // Update page recency: set to 15, decrement others in set
     UpdateRecencyInSet(set_idx, prt);
 
@@ -309,4 +307,19 @@ void DYMPLPredictor::UpdateOnACT(int bank_id, int new_row) {
     predicted_row_[bank_id] = new_row;
 }
 
+void DYMPLPredictor::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(global_counter_);
+    ckpt.Field(prt_);
+    ckpt.Field(brt_);
+    ckpt.Field(bank_pred_);
+    ckpt.Field(predicted_row_);
+    ckpt.Field(wt_page_util_);
+    ckpt.Field(wt_page_hot_);
+    ckpt.Field(wt_page_rec_);
+    ckpt.Field(wt_col_stride_);
+    ckpt.Field(wt_page_hitcnt_);
+    ckpt.Field(wt_bank_rec_);
+    ckpt.Field(wt_bank_hitcnt_);
+}
+
 }  // namespace dramsim3
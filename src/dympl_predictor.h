@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <vector>
+#include "checkpoint.h"
 #include "simple_stats.h"
 
 namespace dramsim3 {
@@ -28,16 +29,14 @@ struct PRTEntry {
     int row_id;           // tag
     int last_col_id;      // last column accessed
     int utilization;      // 4-bit [0,15] spatial locality
-    int hotness;          // 5-bit [0,31] lifetime access frequency
     int recency;          // 4-bit [0,15] temporal locality ranking
     int stride;           // 4-bit [0,15] column stride
     int hit_count;        // 4-bit signed [-8,+7] page-level hit/miss tendency
     uint64_t lru_counter; // for LRU replacement
     bool valid;
 
-    PRTEntry() : row_id(-1), last_col_id(-1), utilization(0), hotness(0),
-                 recency(0), stride(0), hit_count(0), lru_counter(0),
-                 valid(false) {}
+    PRTEntry() : row_id(-1), last_col_id(-1), utilization(0), recency(0),
+                 stride(0), hit_count(0), lru_counter(0), valid(false) {}
 };
 
 struct BRTEntry {
@@ -72,7 +71,9 @@ public:
     DYMPLPredictor(int num_banks, SimpleStats& stats);
 
     // Returns true if page should stay OPEN, false if should auto-precharge (CLOSE)
-    bool Predict(int bank_id, int row, int col);
+    // hotness is the row's decayed access count from the channel's
+    // RowActivityTracker, saturated to the 5-bit page hotness feature
+    bool Predict(int bank_id, int row, int col, uint32_t hotness);
 
     // Update features when a CAS command is processed
     void UpdateOnCAS(int bank_id, int row, int col, bool is_row_hit);
@@ -81,6 +82,9 @@ public:
     void TrainOnACT(int bank_id, int new_row);
     void UpdateOnACT(int bank_id, int new_row);
 
+    // learned tables and per bank predictions
+    void Serialize(Checkpoint& ckpt);
+
 private:
     int num_banks_;
     SimpleStats& simple_stats_;
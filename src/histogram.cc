@@ -0,0 +1,97 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dramsim3 {
+
+static constexpr uint64_t HISTO_SUB_COUNT = 1ull << HISTO_SUB_BITS;
+static constexpr uint64_t HISTO_HALF_COUNT = HISTO_SUB_COUNT >> 1;
+
+LogLinearHistogram::LogLinearHistogram() : total_(0), sum_(0), max_(0) {}
+
+size_t LogLinearHistogram::BucketIndex(uint64_t value) {
+    if (value < HISTO_SUB_COUNT) {
+        return value;
+    }
+    // the top HISTO_SUB_BITS bits of value pick the bucket
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - (HISTO_SUB_BITS - 1);
+    return HISTO_SUB_COUNT + (msb - HISTO_SUB_BITS) * HISTO_HALF_COUNT +
+           ((value >> shift) - HISTO_HALF_COUNT);
+}
+
+uint64_t LogLinearHistogram::BucketLow(size_t idx) {
+    if (idx < HISTO_SUB_COUNT) {
+        return idx;
+    }
+    uint64_t range = (idx - HISTO_SUB_COUNT) / HISTO_HALF_COUNT;
+    uint64_t sub = (idx - HISTO_SUB_COUNT) % HISTO_HALF_COUNT;
+    return (HISTO_HALF_COUNT + sub) << (range + 1);
+}
+
+uint64_t LogLinearHistogram::BucketHigh(size_t idx) {
+    if (idx < HISTO_SUB_COUNT) {
+        return idx;
+    }
+    uint64_t range = (idx - HISTO_SUB_COUNT) / HISTO_HALF_COUNT;
+    return BucketLow(idx) + (1ull << (range + 1)) - 1;
+}
+
+void LogLinearHistogram::Record(uint64_t value, uint64_t count) {
+    size_t idx = BucketIndex(value);
+    if (idx >= counts_.size()) {
+        counts_.resize(idx + 1, 0);
+    }
+    counts_[idx] += count;
+    total_ += count;
+    sum_ += value * count;
+    max_ = std::max(max_, value);
+}
+
+void LogLinearHistogram::Merge(const LogLinearHistogram& other) {
+    if (other.counts_.size() > counts_.size()) {
+        counts_.resize(other.counts_.size(), 0);
+    }
+    for (size_t i = 0; i < other.counts_.size(); i++) {
+        counts_[i] += other.counts_[i];
+    }
+    total_ += other.total_;
+    sum_ += other.sum_;
+    max_ = std::max(max_, other.max_);
+}
+
+void LogLinearHistogram::Clear() {
+    counts_.clear();
+    total_ = 0;
+    sum_ = 0;
+    max_ = 0;
+}
+
+double LogLinearHistogram::Mean() const {
+    return total_ == 0 ? 0.0 : static_cast<double>(sum_) / total_;
+}
+
+uint64_t LogLinearHistogram::Percentile(double quantile) const {
+    if (total_ == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(std::ceil(quantile * total_));
+    uint64_t accu = 0;
+    for (size_t i = 0; i < counts_.size(); i++) {
+        accu += counts_[i];
+        if (accu >= target && counts_[i] > 0) {
+            return std::min(BucketHigh(i), max_);
+        }
+    }
+    return max_;
+}
+
+void LogLinearHistogram::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(counts_);
+    ckpt.Field(total_);
+    ckpt.Field(sum_);
+    ckpt.Field(max_);
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,58 @@
+#ifndef __HISTOGRAM_H
+#define __HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+#include "checkpoint.h"
+
+namespace dramsim3 {
+
+// values below 2^HISTO_SUB_BITS are counted exactly
+static constexpr int HISTO_SUB_BITS = 7;
+
+// Log-linear (HDR style) histogram of non-negative values. Values below
+// 2^HISTO_SUB_BITS get a bucket each, every power of two above is split
+// into 2^(HISTO_SUB_BITS - 1) equal buckets, so a reported value is off by
+// less than 1/64 of itself. Recording is O(1), the bucket array only grows
+// with the log of the largest value, and histograms of different channels
+// or epochs merge by adding buckets.
+class LogLinearHistogram {
+   public:
+    LogLinearHistogram();
+    void Record(uint64_t value, uint64_t count = 1);
+    void Merge(const LogLinearHistogram& other);
+    void Clear();
+    uint64_t Count() const { return total_; }
+    uint64_t Max() const { return max_; }
+    // exact, from the running sum
+    double Mean() const;
+    // smallest value that at least quantile of the values are at or below,
+    // reported as the top of its bucket, 0 if empty
+    uint64_t Percentile(double quantile) const;
+    // calls fn(low, high, count) for every non-empty bucket in value order
+    template <typename F>
+    void ForEachBucket(F fn) const;
+    void Serialize(Checkpoint& ckpt);
+
+   private:
+    static size_t BucketIndex(uint64_t value);
+    static uint64_t BucketLow(size_t idx);
+    static uint64_t BucketHigh(size_t idx);
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_;
+    uint64_t sum_;
+    uint64_t max_;
+};
+
+template <typename F>
+void LogLinearHistogram::ForEachBucket(F fn) const {
+    for (size_t i = 0; i < counts_.size(); i++) {
+        if (counts_[i] > 0) {
+            fn(BucketLow(i), BucketHigh(i), counts_[i]);
+        }
+    }
+}
+
+}  // namespace dramsim3
+#endif
@@ -247,7 +247,8 @@ HMCMemorySystem::HMCMemorySystem(Config &config, const std::string &output_dir,
       logic_clk_(0),
       logic_ps_(0),
       dram_ps_(0),
-      next_link_(0) {
+      next_link_(0),
+      next_tag_(0) {
     // sanity check, this constructor should only be intialized using HMC
     if (!config_.IsHMC()) {
         std::cerr << "Initialzed an HMC system without an HMC config file!"
@@ -340,7 +341,7 @@ bool HMCMemorySystem::WillAcceptTransaction(uint64_t hex_addr,
     return insertable;
 }
 
-bool HMCMemorySystem::AddTransaction(uint64_t hex_addr, bool is_write) {
+HMCReqType HMCMemorySystem::BlockReqType(bool is_write) const {
     // to be compatible with other protocol we have this interface
     // when using this intreface the size of each transaction will be block_size
     HMCReqType req_type;
@@ -389,11 +390,31 @@ bool HMCMemorySystem::AddTransaction(uint64_t hex_addr, bool is_write) {
                 break;
         }
     }
+    return req_type;
+}
+
+bool HMCMemorySystem::AddTransaction(uint64_t hex_addr, bool is_write) {
     int vault = GetChannel(hex_addr);
-    HMCRequest *req = new HMCRequest(req_type, hex_addr, vault);
+    HMCRequest *req = new HMCRequest(BlockReqType(is_write), hex_addr, vault);
     return InsertHMCReq(req);
 }
 
+size_t HMCMemorySystem::AddTransactions(const MemRequest *requests,
+                                        size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const auto &r = requests[i];
+        if (!WillAcceptTransaction(r.addr, r.is_write)) {
+            return i;
+        }
+        HMCRequest *req = new HMCRequest(BlockReqType(r.is_write), r.addr,
+                                         GetChannel(r.addr));
+        req->id = r.id;
+        req->meta = r.meta;
+        InsertHMCReq(req);
+    }
+    return count;
+}
+
 bool HMCMemorySystem::InsertReqToLink(HMCRequest *req, int link) {
     // These things need to happen when an HMC request is inserted to a link:
     // 1. check if link queue full
@@ -405,8 +426,10 @@ bool HMCMemorySystem::InsertReqToLink(HMCRequest *req, int link) {
         link_req_queues_[link].push_back(req);
         HMCResponse *resp =
             new HMCResponse(req->mem_operand, req->type, link, req->quad);
-        resp_lookup_table_.insert(
-            std::pair<uint64_t, HMCResponse *>(resp->resp_id, resp));
+        resp->id = req->id;
+        resp->meta = req->meta;
+        req->tag = next_tag_++;
+        resp_lookup_table_[req->tag] = resp;
         link_age_counter_[link] = 1;
         // stats_.interarrival_latency.AddValue(clk_ - last_req_clk_);
         last_req_clk_ = clk_;
@@ -497,11 +520,11 @@ void HMCMemorySystem::DrainResponses() {
         if (!link_resp_queues_[i].empty()) {
             HMCResponse *resp = link_resp_queues_[i].front();
             if (resp->exit_time <= logic_clk_) {
-                if (resp->type == HMCRespType::RD_RS) {
-                    read_callback_(resp->resp_id);
-                } else {
-                    write_callback_(resp->resp_id);
-                }
+                bool is_write = resp->type != HMCRespType::RD_RS;
+                Transaction trans(resp->resp_id, is_write);
+                trans.id = resp->id;
+                trans.meta = resp->meta;
+                Complete(trans, is_write);
                 delete (resp);
                 link_resp_queues_[i].erase(link_resp_queues_[i].begin());
             }
@@ -544,14 +567,11 @@ void HMCMemorySystem::DrainResponses() {
 void HMCMemorySystem::DRAMClockTick() {
     for (size_t i = 0; i < ctrls_.size(); i++) {
         // look ahead and return earlier
-        while (true) {
-            auto pair = ctrls_[i]->ReturnDoneTrans(clk_);
-            if (pair.second == 1) {  // write
-                VaultCallback(pair.first);
-            } else if (pair.second == 0) {  // read
-                VaultCallback(pair.first);
-            } else {
-                break;
+        Transaction trans;
+        int type;
+        while ((type = ctrls_[i]->ReturnDoneTrans(clk_, trans)) >= 0) {
+            if (type == 0 || type == 1) {
+                VaultCallback(trans.id);
             }
         }
     }
@@ -614,17 +634,16 @@ std::vector<int> HMCMemorySystem::BuildAgeQueue(std::vector<int> &age_counter) {
 
 void HMCMemorySystem::InsertReqToDRAM(HMCRequest *req) {
     Transaction trans(req->mem_operand, req->is_write);
+    trans.id = req->tag;
     ctrls_[req->vault]->AddTransaction(trans);
     return;
 }
 
-void HMCMemorySystem::VaultCallback(uint64_t req_id) {
-    // we will use hex addr as the req_id and use a multimap to lookup the
-    // requests the vaults cannot directly talk to the CPU so this callback will
-    // be passed to the vaults and is responsible to put the responses back to
-    // response queues
+void HMCMemorySystem::VaultCallback(uint64_t tag) {
+    // the vaults cannot directly talk to the CPU so this callback is
+    // responsible to put the responses back to response queues
 
-    auto it = resp_lookup_table_.find(req_id);
+    auto it = resp_lookup_table_.find(tag);
     HMCResponse *resp = it->second;
     // all data from dram received, put packet in xbar and return
     resp_lookup_table_.erase(it);
@@ -634,4 +653,9 @@ void HMCMemorySystem::VaultCallback(uint64_t req_id) {
     return;
 }
 
+void HMCMemorySystem::Serialize(Checkpoint& ckpt) {
+    std::cerr << "Checkpoints are not supported for HMC" << std::endl;
+    AbruptExit(__FILE__, __LINE__);
+}
+
 }  // namespace dramsim3
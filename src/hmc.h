@@ -2,7 +2,7 @@
 #define __HMC_H
 
 #include <functional>
-#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "dram_system.h"
@@ -88,6 +88,10 @@ class HMCRequest {
     bool is_write;
     // this exit_time is the time to exit xbar to vaults
     uint64_t exit_time;
+    // caller's id and metadata, and the tag matching the vault completion
+    uint64_t id = 0;
+    uint64_t meta = 0;
+    uint64_t tag = 0;
 };
 
 class HMCResponse {
@@ -100,6 +104,8 @@ class HMCResponse {
     int flits;
     // this exit_time is the time to exit xbar to cpu
     uint64_t exit_time;
+    uint64_t id = 0;
+    uint64_t meta = 0;
 };
 
 class HMCMemorySystem : public BaseDRAMSystem {
@@ -114,10 +120,15 @@ class HMCMemorySystem : public BaseDRAMSystem {
     void ClockTick() override;
 
     // had to have 3 insert interfaces cuz HMC is so different...
+    using BaseDRAMSystem::WillAcceptTransaction;
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const override;
+    using BaseDRAMSystem::AddTransaction;
     bool AddTransaction(uint64_t hex_addr, bool is_write) override;
+    size_t AddTransactions(const MemRequest* requests, size_t count) override;
     bool InsertReqToLink(HMCRequest* req, int link);
     bool InsertHMCReq(HMCRequest* req);
+    // link and crossbar state is not checkpointed
+    void Serialize(Checkpoint& ckpt) override;
 
    private:
     uint64_t logic_clk_, ps_per_dram_, ps_per_logic_, logic_ps_, dram_ps_;
@@ -127,7 +138,9 @@ class HMCMemorySystem : public BaseDRAMSystem {
     void DrainRequests();
     void DrainResponses();
     void InsertReqToDRAM(HMCRequest* req);
-    void VaultCallback(uint64_t req_id);
+    void VaultCallback(uint64_t tag);
+    // request type moving one block, as the generic interfaces do
+    HMCReqType BlockReqType(bool is_write) const;
     std::vector<int> BuildAgeQueue(std::vector<int>& age_counter);
     void XbarArbitrate();
     inline void IterateNextLink();
@@ -139,9 +152,10 @@ class HMCMemorySystem : public BaseDRAMSystem {
     // number of flits xbar can process per logic cycle
     const int xbar_bandwidth_ = 2;
 
-    // had to use a multimap because the controller callback return hex addr
-    // instead of unique id
-    std::multimap<uint64_t, HMCResponse*> resp_lookup_table_;
+    // responses waiting on the vaults, by the tag their transaction carries
+    // as its id
+    std::unordered_map<uint64_t, HMCResponse*> resp_lookup_table_;
+    uint64_t next_tag_;
     // these are essentially input/output buffers for xbars
     std::vector<std::vector<HMCRequest*>> link_req_queues_;
     std::vector<std::vector<HMCResponse*>> link_resp_queues_;
@@ -25,6 +25,28 @@ int main(int argc, const char **argv) {
         parser, "trace",
         "Trace file, setting this option will ignore -s option",
         {'t', "trace"});
+    args::ValueFlag<uint64_t> warmup_arg(
+        parser, "warmup",
+        "Functionally warm the memory with the first cycles of the trace, "
+        "then simulate -c cycles in detail",
+        {"warmup"}, 0);
+    args::ValueFlag<std::string> save_arg(
+        parser, "save",
+        "Save the memory and CPU state to this file at the end",
+        {"save-checkpoint"});
+    args::ValueFlag<std::string> restore_arg(
+        parser, "restore",
+        "Restore the memory and CPU state from this file first",
+        {"restore-checkpoint"});
+    args::Flag pipeline_arg(
+        parser, "pipeline",
+        "Parse the trace and print completions on a helper thread",
+        {"pipeline"});
+    args::ValueFlag<int> shards_arg(
+        parser, "shards",
+        "Replay the trace open-loop with the channels simulated "
+        "independently on this many threads (0: one per core)",
+        {"shards"}, -1);
     args::Positional<std::string> config_arg(
         parser, "config", "The config file name (mandatory)");
 
@@ -49,10 +71,27 @@ int main(int argc, const char **argv) {
     std::string output_dir = args::get(output_dir_arg);
     std::string trace_file = args::get(trace_file_arg);
     std::string stream_type = args::get(stream_arg);
+    uint64_t warmup = args::get(warmup_arg);
+    std::string save_file = args::get(save_arg);
+    std::string restore_file = args::get(restore_arg);
+
+    int shards = args::get(shards_arg);
+
+    if (warmup > 0 && trace_file.empty()) {
+        std::cerr << "--warmup needs a trace file" << std::endl;
+        return 1;
+    }
+    if (shards >= 0 && (trace_file.empty() || warmup > 0 || pipeline_arg)) {
+        std::cerr << "--shards needs a trace file and no --warmup or --pipeline"
+                  << std::endl;
+        return 1;
+    }
 
     CPU *cpu;
+    TraceBasedCPU *trace_cpu = nullptr;
     if (!trace_file.empty()) {
-        cpu = new TraceBasedCPU(config_file, output_dir, trace_file);
+        trace_cpu = new TraceBasedCPU(config_file, output_dir, trace_file);
+        cpu = trace_cpu;
     } else {
         if (stream_type == "stream" || stream_type == "s") {
             cpu = new StreamCPU(config_file, output_dir);
@@ -61,9 +100,31 @@ int main(int argc, const char **argv) {
         }
     }
 
-    for (uint64_t clk = 0; clk < cycles; clk++) {
+    if (!restore_file.empty()) {
+        // -c counts on from the restored CPU clock
+        cpu->RestoreCheckpoint(restore_file);
+        cycles += cpu->GetClk();
+    }
+    if (pipeline_arg) {
+        cpu->StartPipeline();
+    }
+    if (warmup > 0) {
+        trace_cpu->Warmup(warmup);
+        cpu->ResetStats();
+        cycles += warmup;
+    }
+
+    if (shards >= 0) {
+        trace_cpu->Replay(cycles, shards);
+    }
+    // sampled runs fast-forward the CPU clock between windows
+    while (cpu->GetClk() < cycles) {
         cpu->ClockTick();
     }
+    // saved before the final stats fold the last epoch into the totals
+    if (!save_file.empty()) {
+        cpu->SaveCheckpoint(save_file);
+    }
     cpu->PrintStats();
 
     delete cpu;
@@ -1,11 +1,14 @@
 #include "memory_system.h"
+#include "checkpoint.h"
 
 namespace dramsim3 {
 MemorySystem::MemorySystem(const std::string &config_file,
                            const std::string &output_dir,
                            std::function<void(uint64_t)> read_callback,
                            std::function<void(uint64_t)> write_callback)
-    : config_(new Config(config_file, output_dir)) {
+    : config_(new Config(config_file, output_dir)),
+      sample_clk_(0),
+      sample_skip_(0) {
     // TODO: ideal memory type?
     if (config_->IsHMC()) {
         dram_system_ = new HMCMemorySystem(*config_, output_dir, read_callback,
@@ -21,7 +24,34 @@ MemorySystem::~MemorySystem() {
     delete (config_);
 }
 
-void MemorySystem::ClockTick() { dram_system_->ClockTick(); }
+void MemorySystem::ClockTick() {
+    if (config_->sample_window == 0) {
+        dram_system_->ClockTick();
+        return;
+    }
+    // detailed warmup, then the measured window
+    if (sample_clk_ == config_->sample_warmup) {
+        dram_system_->BeginSampleWindow();
+    }
+    dram_system_->ClockTick();
+    sample_clk_++;
+    if (sample_clk_ == config_->sample_warmup + config_->sample_window) {
+        dram_system_->EndSampleWindow();
+        sample_skip_ = config_->sample_interval - sample_clk_;
+        sample_clk_ = 0;
+    }
+}
+
+uint64_t MemorySystem::SampleSkipCycles() {
+    uint64_t skip = sample_skip_;
+    sample_skip_ = 0;
+    return skip;
+}
+
+void MemorySystem::TakeEpochRowStats(uint64_t &row_hits,
+                                     uint64_t &row_misses) {
+    dram_system_->TakeEpochRowStats(row_hits, row_misses);
+}
 
 double MemorySystem::GetTCK() const { return config_->tCK; }
 
@@ -45,19 +75,116 @@ void MemorySystem::RegisterACTCallback(
     dram_system_->RegisterACTCallback(act_callback);
 }
 
+void MemorySystem::RegisterPrefetchDropCallback(
+    std::function<void(uint64_t)> prefetch_drop_callback) {
+    dram_system_->RegisterPrefetchDropCallback(prefetch_drop_callback);
+}
+
 bool MemorySystem::WillAcceptTransaction(uint64_t hex_addr,
                                          bool is_write) const {
     return dram_system_->WillAcceptTransaction(hex_addr, is_write);
 }
 
+bool MemorySystem::WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                                         int source_id) const {
+    return dram_system_->WillAcceptTransaction(hex_addr, is_write, source_id);
+}
+
+void MemorySystem::SetSourceBandwidth(int source_id, double limit,
+                                      double reservation) {
+    dram_system_->SetSourceBandwidth(source_id, limit, reservation);
+}
+
 bool MemorySystem::AddTransaction(uint64_t hex_addr, bool is_write) {
     return dram_system_->AddTransaction(hex_addr, is_write);
 }
 
+bool MemorySystem::AddTransaction(uint64_t hex_addr, bool is_write,
+                                  int source_id) {
+    return dram_system_->AddTransaction(hex_addr, is_write, source_id);
+}
+
+bool MemorySystem::AddTransaction(uint64_t hex_addr, bool is_write,
+                                  int source_id, int qos_class,
+                                  uint64_t deadline) {
+    return dram_system_->AddTransaction(hex_addr, is_write, source_id,
+                                        qos_class, deadline);
+}
+
+bool MemorySystem::AddPrefetch(uint64_t hex_addr, int source_id) {
+    return dram_system_->AddPrefetch(hex_addr, source_id);
+}
+
+bool MemorySystem::AddRequest(const MemRequest &request) {
+    return dram_system_->AddTransactions(&request, 1) == 1;
+}
+
+void MemorySystem::RegisterCompletionCallback(
+    std::function<void(const MemCompletion &)> completion_callback) {
+    dram_system_->RegisterCompletionCallback(completion_callback);
+}
+
+size_t MemorySystem::AddTransactions(const MemRequest *requests,
+                                     size_t count) {
+    return dram_system_->AddTransactions(requests, count);
+}
+
+void MemorySystem::SetBatchedCompletions(bool batched) {
+    dram_system_->SetBatchedCompletions(batched);
+}
+
+void MemorySystem::TakeCompletions(std::vector<MemCompletion> &done) {
+    dram_system_->TakeCompletions(done);
+}
+
+void MemorySystem::WarmTransaction(uint64_t hex_addr, bool is_write,
+                                   uint64_t cycle) {
+    dram_system_->WarmTransaction(hex_addr, is_write, cycle);
+}
+
+void MemorySystem::EndWarmup(uint64_t cycles) {
+    dram_system_->EndWarmup(cycles);
+}
+
+StatsSnapshot MemorySystem::GetStatsSnapshot() const {
+    StatsSnapshot snap;
+    dram_system_->GetStatsSnapshot(snap);
+    return snap;
+}
+
+void MemorySystem::ReplayTrace(const std::string &trace_file, uint64_t cycles,
+                               int threads) {
+    if (config_->sample_window != 0) {
+        std::cerr << "Trace replay does not support sampling" << std::endl;
+        AbruptExit(__FILE__, __LINE__);
+    }
+    dram_system_->ReplayTrace(trace_file, cycles, threads);
+}
+
 void MemorySystem::PrintStats() const { dram_system_->PrintStats(); }
 
 void MemorySystem::ResetStats() { dram_system_->ResetStats(); }
 
+void MemorySystem::Save(const std::string &file_name,
+                        const std::string &host_key,
+                        const std::function<void(Checkpoint &)> &host) {
+    Checkpoint ckpt(file_name, false);
+    ckpt.Field(sample_clk_);
+    ckpt.Field(sample_skip_);
+    dram_system_->Serialize(ckpt);
+    ckpt.Block(host ? host_key : "", [&] { host(ckpt); });
+}
+
+void MemorySystem::Restore(const std::string &file_name,
+                           const std::string &host_key,
+                           const std::function<void(Checkpoint &)> &host) {
+    Checkpoint ckpt(file_name, true);
+    ckpt.Field(sample_clk_);
+    ckpt.Field(sample_skip_);
+    dram_system_->Serialize(ckpt);
+    ckpt.Block(host ? host_key : "", [&] { host(ckpt); });
+}
+
 MemorySystem* GetMemorySystem(const std::string &config_file, const std::string &output_dir,
                  std::function<void(uint64_t)> read_callback,
                  std::function<void(uint64_t)> write_callback) {
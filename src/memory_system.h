@@ -10,6 +10,8 @@
 
 namespace dramsim3 {
 
+class Checkpoint;
+
 // This should be the interface class that deals with CPU
 class MemorySystem {
    public:
@@ -30,9 +32,75 @@ class MemorySystem {
     int GetQueueSize() const;
     void PrintStats() const;
     void ResetStats();
+    // complete simulator state as a versioned binary file, restore into a
+    // memory system with the same organization, callbacks are not saved.
+    // host walks the caller's own state (e.g. the CPU model) into a block
+    // keyed host_key, restored only by a caller passing the same key
+    void Save(const std::string &file_name, const std::string &host_key = "",
+              const std::function<void(Checkpoint &)> &host = nullptr);
+    void Restore(const std::string &file_name,
+                 const std::string &host_key = "",
+                 const std::function<void(Checkpoint &)> &host = nullptr);
 
     bool WillAcceptTransaction(uint64_t hex_addr, bool is_write) const;
+    // also refuses sources over their bandwidth limit
+    bool WillAcceptTransaction(uint64_t hex_addr, bool is_write,
+                               int source_id) const;
+    // bandwidth limit and reservation of a source as shares of the channel
+    // peak, applied to every channel, 0 for none
+    void SetSourceBandwidth(int source_id, double limit, double reservation);
     bool AddTransaction(uint64_t hex_addr, bool is_write);
+    // source_id tags the requestor for the fairness aware schedulers
+    bool AddTransaction(uint64_t hex_addr, bool is_write, int source_id);
+    // qos_class 0 is the most latency critical, deadline is a latency budget
+    // in DRAM cycles (0 for none), both are used when qos_mode is set
+    bool AddTransaction(uint64_t hex_addr, bool is_write, int source_id,
+                        int qos_class, uint64_t deadline);
+    // a prefetch read, completes through the read callback unless dropped
+    bool AddPrefetch(uint64_t hex_addr, int source_id);
+    // a single request with an id and metadata word, handed back through
+    // the completion callback
+    bool AddRequest(const MemRequest &request);
+    // called with the id and metadata of every finished request instead of
+    // the read and write callbacks
+    void RegisterCompletionCallback(
+        std::function<void(const MemCompletion &)> completion_callback);
+    // batched front end, requests are taken in order until one is refused
+    // and the number taken is returned, offer the rest on a later cycle
+    size_t AddTransactions(const MemRequest *requests, size_t count);
+    // buffer completions for TakeCompletions instead of calling the read
+    // and write callbacks per request
+    void SetBatchedCompletions(bool batched);
+    // replaces done with the completions buffered since the last call
+    void TakeCompletions(std::vector<MemCompletion> &done);
+    // functional warmup: applies an access made cycle cycles into the
+    // warmed span to the open rows and page policy state, without timing,
+    // stats or callbacks. EndWarmup closes a span of cycles, the memory clock
+    // stands still but later accesses see the warmed state that much older
+    void WarmTransaction(uint64_t hex_addr, bool is_write, uint64_t cycle);
+    void EndWarmup(uint64_t cycles);
+    // called for prefetches dropped by prefetch_drop_threshold, without it
+    // dropped prefetches are reported through the read callback
+    void RegisterPrefetchDropCallback(
+        std::function<void(uint64_t)> prefetch_drop_callback);
+    // sampled simulation (sample_window > 0): once a detailed window is
+    // measured, returns the cycles the front end should fast-forward its
+    // input by, the memory state is kept warm across the skip, 0 otherwise
+    uint64_t SampleSkipCycles();
+    // row buffer hits (READ/WRITE to an open row) and misses (ACT) of all
+    // channels since the last call, instance wide epoch counters
+    void TakeEpochRowStats(uint64_t &row_hits, uint64_t &row_misses);
+    // all counters, histograms and derived values at this cycle, without
+    // file output or side effects, counters only grow so consumers polling
+    // every epoch can diff two snapshots
+    StatsSnapshot GetStatsSnapshot() const;
+    // open-loop replay of a trace file for the next cycles: the records are
+    // split by channel and every channel runs its own stream on one of
+    // threads workers (0: one per core), the trace is read and the workers
+    // meet every REPLAY_CHUNK_CYCLES and at each epoch boundary, stats only,
+    // no callbacks
+    void ReplayTrace(const std::string &trace_file, uint64_t cycles,
+                     int threads);
 
    private:
     // These have to be pointers because Gem5 will try to push this object
@@ -40,6 +108,8 @@ class MemorySystem {
     // here is safe
     Config *config_;
     BaseDRAMSystem *dram_system_;
+    uint64_t sample_clk_;   // detailed cycles into the current window
+    uint64_t sample_skip_;  // pending fast-forward after a window
 };
 
 MemorySystem* GetMemorySystem(const std::string &config_file, const std::string &output_dir,
@@ -0,0 +1,50 @@
+#include "next_row_predictor.h"
+#include <algorithm>
+
+namespace dramsim3 {
+
+NextRowPredictor::NextRowPredictor(int num_banks) : banks_(num_banks) {}
+
+void NextRowPredictor::OnActivate(int bank_idx, int row) {
+    auto& bank = banks_[bank_idx];
+    if (bank.last_row >= 0) {
+        auto& entry = bank.table[bank.last_row % NRP_MARKOV_ENTRIES];
+        if (entry.row != bank.last_row) {
+            entry.row = bank.last_row;
+            entry.next_row = row;
+            entry.conf = 1;
+        } else if (entry.next_row == row) {
+            entry.conf = std::min(entry.conf + 1, NRP_CONF_MAX);
+        } else if (--entry.conf <= 0) {
+            entry.next_row = row;
+            entry.conf = 1;
+        }
+
+        int stride = row - bank.last_row;
+        if (stride != 0 && stride == bank.last_stride) {
+            bank.stride_conf = std::min(bank.stride_conf + 1, NRP_CONF_MAX);
+        } else {
+            bank.stride_conf = 0;
+        }
+        bank.last_stride = stride;
+    }
+    bank.last_row = row;
+}
+
+int NextRowPredictor::Predict(int bank_idx) const {
+    const auto& bank = banks_[bank_idx];
+    if (bank.last_row < 0) {
+        return -1;
+    }
+    const auto& entry = bank.table[bank.last_row % NRP_MARKOV_ENTRIES];
+    if (entry.row == bank.last_row && entry.conf >= NRP_CONF_THRESHOLD) {
+        return entry.next_row;
+    }
+    if (bank.stride_conf >= NRP_CONF_THRESHOLD) {
+        int row = bank.last_row + bank.last_stride;
+        return row >= 0 ? row : -1;
+    }
+    return -1;
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,45 @@
+#ifndef __NEXT_ROW_PREDICTOR_H
+#define __NEXT_ROW_PREDICTOR_H
+
+#include <cstdint>
+#include <vector>
+#include "checkpoint.h"
+
+namespace dramsim3 {
+
+// Markov table: 64 direct-mapped entries per bank, indexed by current row
+static constexpr int NRP_MARKOV_ENTRIES = 64;
+// 2-bit confidence, predict at >= NRP_CONF_THRESHOLD
+static constexpr int NRP_CONF_MAX = 3;
+static constexpr int NRP_CONF_THRESHOLD = 2;
+
+struct NRPMarkovEntry {
+    int row = -1;       // tag: row that was activated
+    int next_row = -1;  // row activated after it last time
+    int conf = 0;
+};
+
+struct NRPBankState {
+    int last_row = -1;
+    int last_stride = 0;
+    int stride_conf = 0;
+    NRPMarkovEntry table[NRP_MARKOV_ENTRIES];
+};
+
+// Per bank next-row predictor for speculative activation, trained with the
+// demand ACT stream. A confident Markov transition (row A -> row B) wins,
+// otherwise a repeating row stride is used.
+class NextRowPredictor {
+   public:
+    explicit NextRowPredictor(int num_banks);
+    void OnActivate(int bank_idx, int row);
+    // predicted next row of the bank, -1 if not confident
+    int Predict(int bank_idx) const;
+    void Serialize(Checkpoint& ckpt) { ckpt.Field(banks_); }
+
+   private:
+    std::vector<NRPBankState> banks_;
+};
+
+}  // namespace dramsim3
+#endif
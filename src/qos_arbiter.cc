@@ -0,0 +1,48 @@
+#include "qos_arbiter.h"
+#include <algorithm>
+#include <limits>
+
+namespace dramsim3 {
+
+QoSArbiter::QoSArbiter(const Config& config)
+    : mode_(config.qos_mode),
+      weights_(config.qos_weights),
+      finish_(config.num_qos_classes, 0.0),
+      vtime_(0.0) {}
+
+double QoSArbiter::Key(int qos_class, uint64_t deadline) const {
+    switch (mode_) {
+        case QoSMode::STRICT:
+            return qos_class;
+        case QoSMode::WEIGHTED:
+            // an idle class restarts at the current virtual time instead of
+            // cashing in the service it did not use
+            return std::max(finish_[qos_class], vtime_);
+        case QoSMode::DEADLINE:
+            return deadline == 0 ? std::numeric_limits<double>::max()
+                                 : static_cast<double>(deadline);
+        default:
+            return 0.0;
+    }
+}
+
+bool QoSArbiter::Before(int class_a, uint64_t deadline_a, int class_b,
+                        uint64_t deadline_b) const {
+    return Key(class_a, deadline_a) < Key(class_b, deadline_b);
+}
+
+bool QoSArbiter::Tie(int class_a, uint64_t deadline_a, int class_b,
+                     uint64_t deadline_b) const {
+    return Key(class_a, deadline_a) == Key(class_b, deadline_b);
+}
+
+void QoSArbiter::OnServed(int qos_class) {
+    if (mode_ != QoSMode::WEIGHTED) {
+        return;
+    }
+    double start = std::max(finish_[qos_class], vtime_);
+    finish_[qos_class] = start + 1.0 / weights_[qos_class];
+    vtime_ = start;
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,41 @@
+#ifndef __QOS_ARBITER_H
+#define __QOS_ARBITER_H
+
+#include <cstdint>
+#include <vector>
+#include "checkpoint.h"
+#include "configuration.h"
+
+namespace dramsim3 {
+
+// Orders requests by QoS class for the transaction and the command picker,
+// each picker owns one so weighted service is tracked at its own level.
+// STRICT: lower class first. WEIGHTED: start-time fair queueing over the
+// classes. DEADLINE: earliest deadline first, requests without one last.
+class QoSArbiter {
+   public:
+    explicit QoSArbiter(const Config& config);
+    bool Enabled() const { return mode_ != QoSMode::NONE; }
+    // true if a goes before b, false if b goes first or QoS has no opinion
+    bool Before(int class_a, uint64_t deadline_a, int class_b,
+                uint64_t deadline_b) const;
+    // true if neither request goes before the other
+    bool Tie(int class_a, uint64_t deadline_a, int class_b,
+             uint64_t deadline_b) const;
+    void OnServed(int qos_class);
+    void Serialize(Checkpoint& ckpt) {
+        ckpt.Field(finish_);
+        ckpt.Field(vtime_);
+    }
+
+   private:
+    double Key(int qos_class, uint64_t deadline) const;
+
+    QoSMode mode_;
+    std::vector<double> weights_;
+    std::vector<double> finish_;  // per class virtual finish tag
+    double vtime_;
+};
+
+}  // namespace dramsim3
+#endif
@@ -81,4 +81,11 @@ void Refresh::IterateNext() {
     }
 }
 
+void Refresh::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(clk_);
+    ckpt.Field(next_rank_);
+    ckpt.Field(next_bg_);
+    ckpt.Field(next_bank_);
+}
+
 }  // namespace dramsim3
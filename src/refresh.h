@@ -12,6 +12,7 @@ class Refresh {
    public:
     Refresh(const Config& config, ChannelState& channel_state);
     void ClockTick();
+    void Serialize(Checkpoint& ckpt);
 
    private:
     uint64_t clk_;
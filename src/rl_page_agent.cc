@@ -183,4 +183,10 @@ void RLPageAgent::OnActivate(int bank_id, int new_row) {
     // The reward for CLOSE was already given at the next cluster-end Decide().
 }
 
+void RLPageAgent::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(rng_);
+    ckpt.Field(cmac_);
+    ckpt.Field(bank_ctx_);
+}
+
 }  // namespace dramsim3
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <vector>
 #include <random>
+#include "checkpoint.h"
 #include "simple_stats.h"
 
 namespace dramsim3 {
@@ -55,6 +56,9 @@ public:
     //   - If previous decision was KEEP_OPEN, we can now compute reward
     void OnActivate(int bank_id, int new_row);
 
+    // CMAC table, exploration RNG and pending per bank decisions
+    void Serialize(Checkpoint& ckpt);
+
 private:
     int num_banks_;
     SimpleStats& stats_;
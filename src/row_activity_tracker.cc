@@ -0,0 +1,97 @@
+#include "row_activity_tracker.h"
+#include <algorithm>
+#include <limits>
+
+namespace dramsim3 {
+
+RowActivityTracker::RowActivityTracker(int num_banks)
+    : num_banks_(num_banks),
+      sketch_(ROW_TRACKER_DEPTH << ROW_TRACKER_WIDTH_BITS, 0),
+      slots_(1 << ROW_TRACKER_SLOT_BITS),
+      touches_(0) {}
+
+uint64_t RowActivityTracker::Key(int bank_idx, int row) const {
+    return static_cast<uint64_t>(row) * num_banks_ + bank_idx;
+}
+
+uint32_t RowActivityTracker::Hash(uint64_t key, int seed) {
+    // multiplicative hash, a different odd multiplier per seed
+    uint64_t h = (key + 1) * (0x9E3779B97F4A7C15ull + 2 * seed);
+    return static_cast<uint32_t>(h >> 32);
+}
+
+void RowActivityTracker::Touch(int bank_idx, int row, uint64_t clk) {
+    uint64_t key = Key(bank_idx, row);
+
+    // conservative update, only the minimal counters are raised
+    uint16_t* cells[ROW_TRACKER_DEPTH];
+    uint16_t min_count = std::numeric_limits<uint16_t>::max();
+    for (int d = 0; d < ROW_TRACKER_DEPTH; d++) {
+        uint32_t col = Hash(key, d) >> (32 - ROW_TRACKER_WIDTH_BITS);
+        cells[d] = &sketch_[(d << ROW_TRACKER_WIDTH_BITS) + col];
+        min_count = std::min(min_count, *cells[d]);
+    }
+    if (min_count < std::numeric_limits<uint16_t>::max()) {
+        for (int d = 0; d < ROW_TRACKER_DEPTH; d++) {
+            if (*cells[d] == min_count) {
+                (*cells[d])++;
+            }
+        }
+    }
+
+    Slot& a = slots_[Hash(key, 0) & ((1 << ROW_TRACKER_SLOT_BITS) - 1)];
+    Slot& b = slots_[Hash(key, 1) & ((1 << ROW_TRACKER_SLOT_BITS) - 1)];
+    if (a.key == key + 1) {
+        a.clk = clk;
+    } else if (b.key == key + 1) {
+        b.clk = clk;
+    } else {
+        Slot& victim = a.clk <= b.clk ? a : b;
+        victim.key = key + 1;
+        victim.clk = clk;
+    }
+
+    touches_++;
+    if (touches_ % ROW_TRACKER_DECAY_TOUCHES == 0) {
+        Decay();
+    }
+}
+
+uint32_t RowActivityTracker::Hotness(int bank_idx, int row) const {
+    uint64_t key = Key(bank_idx, row);
+    uint16_t min_count = std::numeric_limits<uint16_t>::max();
+    for (int d = 0; d < ROW_TRACKER_DEPTH; d++) {
+        uint32_t col = Hash(key, d) >> (32 - ROW_TRACKER_WIDTH_BITS);
+        min_count =
+            std::min(min_count, sketch_[(d << ROW_TRACKER_WIDTH_BITS) + col]);
+    }
+    return min_count;
+}
+
+bool RowActivityTracker::LastTouch(int bank_idx, int row,
+                                   uint64_t& clk) const {
+    uint64_t key = Key(bank_idx, row);
+    for (int seed = 0; seed < 2; seed++) {
+        const Slot& slot =
+            slots_[Hash(key, seed) & ((1 << ROW_TRACKER_SLOT_BITS) - 1)];
+        if (slot.key == key + 1) {
+            clk = slot.clk;
+            return true;
+        }
+    }
+    return false;
+}
+
+void RowActivityTracker::Decay() {
+    for (auto& count : sketch_) {
+        count >>= 1;
+    }
+}
+
+void RowActivityTracker::Serialize(Checkpoint& ckpt) {
+    ckpt.Field(sketch_);
+    ckpt.Field(slots_);
+    ckpt.Field(touches_);
+}
+
+}  // namespace dramsim3
@@ -0,0 +1,47 @@
+#ifndef __ROW_ACTIVITY_TRACKER_H
+#define __ROW_ACTIVITY_TRACKER_H
+
+#include <cstdint>
+#include <vector>
+#include "checkpoint.h"
+
+namespace dramsim3 {
+
+static constexpr int ROW_TRACKER_DEPTH = 4;        // count-min hash rows
+static constexpr int ROW_TRACKER_WIDTH_BITS = 10;  // 1024 counters per row
+static constexpr int ROW_TRACKER_SLOT_BITS = 10;   // 1024 recency slots
+static constexpr uint64_t ROW_TRACKER_DECAY_TOUCHES = 8192;
+
+// Per channel row activity tracker shared by policies and stats.
+// Hotness comes from a count-min sketch of decayed access counts (halved
+// every ROW_TRACKER_DECAY_TOUCHES touches), it may over count but never
+// under counts. Last touch times come from a small exact table with two
+// candidate slots per row, the older of the two is replaced on a miss.
+// Both lookups are O(1).
+class RowActivityTracker {
+   public:
+    explicit RowActivityTracker(int num_banks);
+    void Touch(int bank_idx, int row, uint64_t clk);
+    // decayed access count estimate
+    uint32_t Hotness(int bank_idx, int row) const;
+    // false if the row is not (or no longer) in the recency table
+    bool LastTouch(int bank_idx, int row, uint64_t& clk) const;
+    void Serialize(Checkpoint& ckpt);
+
+   private:
+    struct Slot {
+        uint64_t key = 0;  // key + 1, 0 for an empty slot
+        uint64_t clk = 0;
+    };
+    uint64_t Key(int bank_idx, int row) const;
+    static uint32_t Hash(uint64_t key, int seed);
+    void Decay();
+
+    int num_banks_;
+    std::vector<uint16_t> sketch_;  // DEPTH x WIDTH
+    std::vector<Slot> slots_;
+    uint64_t touches_;
+};
+
+}  // namespace dramsim3
+#endif
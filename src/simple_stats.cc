@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "fmt/format.h"
@@ -28,6 +30,16 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
     InitStat("num_write_row_hits", "counter",
              "Number of write row buffer hits");
     InitStat("num_read_cmds", "counter", "Number of READ/READP commands");
+    InitStat("num_prefetches", "counter", "Number of prefetch requests");
+    InitStat("num_prefetches_done", "counter",
+             "Number of prefetch requests completed");
+    InitStat("num_prefetches_dropped", "counter",
+             "Prefetches dropped after prefetch_drop_threshold");
+    InitStat("num_prefetch_upgrades", "counter",
+             "Queued prefetches turned into demands by a later read");
+    InitStat("num_prefetch_cmds", "counter", "READ/READP commands of prefetches");
+    InitStat("num_prefetch_row_hits", "counter",
+             "Number of prefetch read row buffer hits");
     InitStat("num_write_cmds", "counter", "Number of WRITE/WRITEP commands");
     InitStat("num_act_cmds", "counter", "Number of ACT commands");
     InitStat("num_pre_cmds", "counter", "Number of PRE commands");
@@ -41,6 +53,62 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
              "Number of read-to-write bus turnaround events");
     InitStat("num_write_to_read", "counter",
              "Number of write-to-read bus turnaround events");
+    InitStat("num_cas_pairs_tccd_l", "counter",
+             "Back-to-back CAS pairs within one bank group (tCCD_L)");
+    InitStat("num_cas_pairs_tccd_s", "counter",
+             "Back-to-back CAS pairs across bank groups (tCCD_S)");
+    InitStat("num_bg_interleave_picks", "counter",
+             "CAS picked out of round robin order to switch bank group");
+    InitStat("num_pre_for_proactive", "counter",
+             "Early PREs issued by the proactive precharge engine");
+    InitStat("num_proactive_pre_useful", "counter",
+             "Proactive PREs followed by an ACT to another row");
+    InitStat("num_proactive_pre_same_row", "counter",
+             "Proactive PREs followed by an ACT to the same row");
+    InitStat("spec_acts", "counter", "Speculative ACTs issued");
+    InitStat("num_row_prefetch_reads", "counter",
+             "READs issued by the row prefetcher");
+    InitStat("row_prefetch_hits", "counter",
+             "Reads served from the row prefetch buffer");
+    InitStat("row_prefetch_useful", "counter",
+             "Row prefetched lines read at least once");
+    InitStat("row_prefetch_evicted_unused", "counter",
+             "Row prefetched lines evicted without a read");
+    InitStat("spec_act_hits", "counter",
+             "Speculative rows served by a demand CAS");
+    InitStat("spec_act_misses", "counter",
+             "Speculative rows closed without a demand CAS");
+    InitStat("spec_act_timeouts", "counter",
+             "Speculative rows closed by the engine timeout");
+    InitStat("num_aged_promotions", "counter",
+             "PREs allowed early because the request exceeded max_request_age");
+    InitStat("row_hit_cap_shrinks", "counter",
+             "Adaptive row hit cap decreases (starvation)");
+    InitStat("row_hit_cap_grows", "counter",
+             "Adaptive row hit cap increases (rare conflicts)");
+    InitStat("num_bw_reserved_picks", "counter",
+             "Commands picked for a source with reserved bandwidth");
+    InitStat("num_trans_row_hit_promoted", "counter",
+             "Transactions scheduled ahead of older ones for row locality");
+    InitStat("num_write_drains", "counter", "Number of write drain bursts");
+    InitStat("parbs_batches", "counter", "PAR-BS batches formed");
+    InitStat("tcm_quanta", "counter", "TCM clustering quanta");
+    InitStat("tcm_shuffles", "counter", "TCM bandwidth cluster shuffles");
+    InitStat("bliss_blacklistings", "counter", "BLISS sources blacklisted");
+    InitStat("duel_switches", "counter", "DUEL follower policy switches");
+    InitStat("rl_sched_decisions", "counter", "RL scheduler decisions");
+    InitStat("rl_sched_explorations", "counter",
+             "RL scheduler epsilon-greedy explorations");
+    InitStat("rl_sched_budget_cuts", "counter",
+             "RL decisions with candidates cut by the budget");
+    InitStat("rl_sched_starvation_picks", "counter",
+             "RL picks overridden by max_request_age");
+    InitStat("num_write_drain_batched", "counter",
+             "Drained writes picked for an open or queued row");
+    InitStat("num_write_drain_rank_switches", "counter",
+             "Rank switches within per-rank write drain bursts");
+    InitStat("num_opportunistic_writes", "counter",
+             "Writes scheduled to ranks with no queued reads");
 
     // Queue occupancy counters
     InitStat("cmd_queue_full_cycles", "counter", "Cycles when cmd queue is full");
@@ -54,6 +122,12 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
     InitStat("write_energy", "double", "Write energy");
     InitStat("ref_energy", "double", "Refresh energy");
     InitStat("refb_energy", "double", "Refresh-bank energy");
+    InitStat("row_prefetch_energy", "double",
+             "Read energy of row prefetch READs");
+    InitStat("spec_act_energy", "double",
+             "Activation energy of speculative ACTs");
+    InitStat("spec_act_wasted_energy", "double",
+             "Activation energy of missed speculative ACTs");
 
     // Vector counter stats
     InitVecStat("all_bank_idle_cycles", "vec_counter",
@@ -68,16 +142,110 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
                 config_.ranks);
     InitVecStat("pre_stb_energy", "vec_double", "Precharge standby energy",
                 "rank", config_.ranks);
+    InitVecStat("source_reads_done", "vec_counter", "Read requests done",
+                "source", config_.num_sources);
+    InitVecStat("source_read_latency", "vec_counter",
+                "Accumulated read latency (cycles)", "source",
+                config_.num_sources);
+    InitVecStat("source_avg_read_latency", "vec_double",
+                "Average read latency (cycles)", "source", config_.num_sources);
+    InitVecStat("source_slowdown", "vec_double",
+                "Read latency over unloaded latency", "source",
+                config_.num_sources);
+    InitVecStat("source_cas_cmds", "vec_counter", "READ/WRITE commands issued",
+                "source", config_.num_sources);
+    InitVecStat("source_throttled_cycles", "vec_counter",
+                "Cycles over the bandwidth limit", "source",
+                config_.num_sources);
+    InitVecStat("source_bandwidth", "vec_double",
+                "Achieved bandwidth (GB/s)", "source", config_.num_sources);
+    InitVecStat("tcm_latency_cluster", "vec_counter",
+                "TCM quanta spent in the latency cluster", "source",
+                config_.num_sources);
     InitVecStat("sref_energy", "vec_double", "SREF energy", "rank",
                 config_.ranks);
+    InitVecStat("qos_reads_done", "vec_counter", "Read requests done",
+                "class", config_.num_qos_classes);
+    InitVecStat("qos_read_latency", "vec_counter",
+                "Accumulated read latency (cycles)", "class",
+                config_.num_qos_classes);
+    InitVecStat("qos_deadline_misses", "vec_counter",
+                "Reads completed after their deadline", "class",
+                config_.num_qos_classes);
+    InitVecStat("qos_avg_read_latency", "vec_double",
+                "Average read latency (cycles)", "class",
+                config_.num_qos_classes);
+    InitVecStat("qos_p99_read_latency", "vec_double",
+                "99th percentile read latency (cycles)", "class",
+                config_.num_qos_classes);
+    // row hit distance, bucket widths double from 2 * tCCD_S up to tREFI
+    row_hit_distance_base_ = std::max(8, config_.tCCD_S * 2);
+    row_hit_distance_max_ = config_.tREFI > 0 ? config_.tREFI : 10000;
+    row_hit_distance_buckets_ = 0;
+    std::vector<std::string> distance_ranges;
+    if (config_.row_hit_distance_stats) {
+        uint64_t start = 0;
+        uint64_t width = row_hit_distance_base_;
+        while (start < row_hit_distance_max_) {
+            uint64_t end = std::min(start + width, row_hit_distance_max_);
+            distance_ranges.push_back("[" + std::to_string(start) + "-" +
+                                      std::to_string(end - 1) + "]");
+            start = end;
+            width *= 2;
+        }
+        distance_ranges.push_back(
+            "[>=" + std::to_string(row_hit_distance_max_) + "]");
+        row_hit_distance_buckets_ = static_cast<int>(distance_ranges.size());
+    }
+    InitVecStat("row_hit_distance", "vec_counter", "Row re-touches", "bucket",
+                row_hit_distance_buckets_);
+    for (int i = 0; i < row_hit_distance_buckets_; i++) {
+        header_descs_["row_hit_distance." + std::to_string(i)] =
+            "Row re-touches at distance " + distance_ranges[i] + " (cycles)";
+    }
+
+    // DUEL leader scores, indexed by position in duel_policies
+    int num_duel = config_.row_buf_policy == "DUEL"
+                       ? static_cast<int>(config_.duel_policies.size())
+                       : 0;
+    InitVecStat("duel_leader_reads", "vec_counter", "Leader bank reads done",
+                "policy", num_duel);
+    InitVecStat("duel_leader_latency", "vec_counter",
+                "Accumulated leader read latency (cycles)", "policy",
+                num_duel);
+    InitVecStat("duel_leader_row_hits", "vec_counter", "Leader row hits",
+                "policy", num_duel);
+    InitVecStat("duel_leader_conflicts", "vec_counter",
+                "Leader on-demand precharges", "policy", num_duel);
+    InitVecStat("duel_epochs_won", "vec_counter",
+                "DUEL epochs run by the followers", "policy", num_duel);
+    InitVecStat("duel_leader_avg_latency", "vec_double",
+                "Average leader read latency (cycles)", "policy", num_duel);
 
     // Histogram stats
     InitHistoStat("read_latency", "Read request latency (cycles)", 0, 200, 10);
     InitHistoStat("write_latency", "Write cmd latency (cycles)", 0, 200, 10);
+    InitHistoStat("demand_read_latency",
+                  "Read latency of non-prefetch requests (cycles)", 0, 200, 10);
     InitHistoStat("interarrival_latency",
                   "Request interarrival latency (cycles)", 0, 100, 10);
     InitHistoStat("victim_queue_len", "Victim Queue Length", 0, 100, 20);
     InitHistoStat("max_victim_queue_len", "Max Victim Queue Length per Tick", 0, 100, 20);
+    for (int i = 0; i < config_.num_qos_classes; i++) {
+        qos_latency_names_.push_back("qos" + std::to_string(i) +
+                                     "_read_latency");
+        InitHistoStat(qos_latency_names_.back(),
+                      "Read latency of QoS class " + std::to_string(i) +
+                          " (cycles)",
+                      0, 200, 10);
+    }
+    source_reads_done_ = &epoch_vec_counters_.at("source_reads_done");
+    source_read_latency_ = &epoch_vec_counters_.at("source_read_latency");
+    qos_reads_done_ = &epoch_vec_counters_.at("qos_reads_done");
+    qos_read_latency_ = &epoch_vec_counters_.at("qos_read_latency");
+    for (const auto& name : qos_latency_names_) {
+        qos_latency_histos_.push_back(&epoch_histo_counts_.at(name));
+    }
 
     // some irregular stats
     InitStat("average_bandwidth", "calculated", "Average bandwidth");
@@ -85,6 +253,29 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
     InitStat("average_power", "calculated", "Average power (mW)");
     InitStat("average_read_latency", "calculated",
              "Average read request latency (cycles)");
+    InitStat("average_demand_read_latency", "calculated",
+             "Average non-prefetch read latency (cycles)");
+    InitStat("prefetch_row_hit_rate", "calculated",
+             "Row buffer hit rate of prefetch reads");
+    InitStat("row_prefetch_accuracy", "calculated",
+             "Useful row prefetches over row prefetch READs");
+    InitStat("row_prefetch_coverage", "calculated",
+             "Reads served from the row prefetch buffer over all reads");
+    InitStat("p50_read_latency", "calculated",
+             "Median read latency (cycles)");
+    InitStat("p95_read_latency", "calculated",
+             "95th percentile read latency (cycles)");
+    InitStat("p99_read_latency", "calculated",
+             "99th percentile read latency (cycles)");
+    InitStat("p999_read_latency", "calculated",
+             "99.9th percentile read latency (cycles)");
+    InitStat("p9999_read_latency", "calculated",
+             "99.99th percentile read latency (cycles)");
+    InitStat("max_read_latency", "calculated", "Maximum read latency (cycles)");
+    InitStat("max_source_slowdown", "calculated",
+             "Largest per source read slowdown");
+    InitStat("source_unfairness", "calculated",
+             "Max over min per source read slowdown");
     InitStat("average_interarrival", "calculated",
              "Average request interarrival latency (cycles)");
 
@@ -93,6 +284,25 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
     InitStat("cmd_queue_empty_ratio", "calculated", "Ratio of cycles cmd queue is empty");
     InitStat("trans_queue_full_ratio", "calculated", "Ratio of cycles trans queue is full");
     InitStat("trans_queue_empty_ratio", "calculated", "Ratio of cycles trans queue is empty");
+    InitStat("data_bus_utilization", "calculated",
+             "Ratio of cycles the data bus is busy");
+
+    // sampled simulation estimates, mean over windows and 95% CI half width
+    if (config_.sample_window > 0) {
+        InitStat("sample_windows", "calculated", "Number of sampled windows");
+        InitStat("sampled_bandwidth", "calculated",
+                 "Sampled average bandwidth");
+        InitStat("sampled_bandwidth_ci95", "calculated",
+                 "95% confidence interval of sampled bandwidth (+/-)");
+        InitStat("sampled_read_latency", "calculated",
+                 "Sampled average read latency (cycles)");
+        InitStat("sampled_read_latency_ci95", "calculated",
+                 "95% confidence interval of sampled read latency (+/-)");
+        InitStat("sampled_row_hit_rate", "calculated",
+                 "Sampled row buffer hit rate of READ/WRITE commands");
+        InitStat("sampled_row_hit_rate_ci95", "calculated",
+                 "95% confidence interval of sampled row hit rate (+/-)");
+    }
 
     // GS accuracy counters (registered for all policies; only incremented under GS/GS_NOHOTROW)
     InitStat("gs_timeout_precharges", "counter",
@@ -173,15 +383,171 @@ SimpleStats::SimpleStats(const Config& config, int channel_id)
              "RL_PAGE SARSA weight updates");
 }
 
-void SimpleStats::AddValue(const std::string name, const int value) {
-    auto& epoch_counts = epoch_histo_counts_[name];
-    if (epoch_counts.count(value) <= 0) {
-        epoch_counts[value] = 1;
-    } else {
-        epoch_counts[value] += 1;
+void SimpleStats::AddRowHitDistance(uint64_t distance) {
+    int bucket = row_hit_distance_buckets_ - 1;
+    if (distance < row_hit_distance_max_) {
+        // floor(log2(distance / base + 1))
+        uint64_t v = distance / row_hit_distance_base_ + 1;
+        bucket = 0;
+        while (v >>= 1) {
+            bucket++;
+        }
+    }
+    epoch_vec_counters_["row_hit_distance"][bucket] += 1;
+}
+
+double SampleMetric::CI95() const {
+    if (n < 2) {
+        return 0.0;
+    }
+    double mean = sum / n;
+    double var = std::max(0.0, (sum_sq - n * mean * mean) / (n - 1));
+    return 1.96 * std::sqrt(var / n);
+}
+
+uint64_t SimpleStats::TotalCount(const std::string& name) const {
+    return counters_.at(name) + epoch_counters_.at(name);
+}
+
+uint64_t SimpleStats::TotalVecCount(const std::string& name) const {
+    uint64_t total = 0;
+    for (auto val : vec_counters_.at(name)) {
+        total += val;
+    }
+    for (auto val : epoch_vec_counters_.at(name)) {
+        total += val;
+    }
+    return total;
+}
+
+void SimpleStats::Snapshot(ChannelStatsSnapshot& snap) const {
+    snap.channel = channel_id_;
+    snap.counters.clear();
+    for (const auto& it : counters_) {
+        snap.counters[it.first] = TotalCount(it.first);
+    }
+    snap.vec_counters.clear();
+    for (const auto& it : vec_counters_) {
+        auto& vec = snap.vec_counters[it.first];
+        const auto& epoch_vec = epoch_vec_counters_.at(it.first);
+        vec = it.second;
+        for (size_t i = 0; i < vec.size(); i++) {
+            vec[i] += epoch_vec[i];
+        }
+    }
+    snap.histograms.clear();
+    LogLinearHistogram read_latency;
+    for (const auto& it : histo_counts_) {
+        LogLinearHistogram total = it.second;
+        total.Merge(epoch_histo_counts_.at(it.first));
+        auto& histo = snap.histograms[it.first];
+        total.ForEachBucket([&](uint64_t low, uint64_t high, uint64_t count) {
+            histo[low] = count;
+        });
+        if (it.first == "read_latency") {
+            read_latency = total;
+        }
+    }
+
+    // derived values as UpdateFinalStats computes them
+    const auto& counters = snap.counters;
+    uint64_t cycles = counters.at("num_cycles");
+    uint64_t reads = counters.at("num_reads_done");
+    uint64_t reqs = reads + counters.at("num_writes_done");
+    snap.average_bandwidth =
+        cycles == 0
+            ? 0.0
+            : reqs * config_.request_size_bytes / (cycles * config_.tCK);
+    snap.average_read_latency = read_latency.Mean();
+    snap.read_latency_p50 = read_latency.Percentile(0.5);
+    snap.read_latency_p99 = read_latency.Percentile(0.99);
+    snap.read_latency_p999 = read_latency.Percentile(0.999);
+    snap.read_latency_p9999 = read_latency.Percentile(0.9999);
+    uint64_t cas = counters.at("num_read_cmds") +
+                   counters.at("num_write_cmds") -
+                   counters.at("num_row_prefetch_reads");
+    uint64_t hits =
+        counters.at("num_read_row_hits") + counters.at("num_write_row_hits");
+    snap.row_hit_rate = cas == 0 ? 0.0 : static_cast<double>(hits) / cas;
+    double energy = counters.at("num_act_cmds") * config_.act_energy_inc +
+                    counters.at("num_read_cmds") * config_.read_energy_inc +
+                    counters.at("num_write_cmds") * config_.write_energy_inc +
+                    counters.at("num_ref_cmds") * config_.ref_energy_inc +
+                    counters.at("num_refb_cmds") * config_.refb_energy_inc;
+    const auto& vec_counters = snap.vec_counters;
+    for (int i = 0; i < config_.ranks; i++) {
+        energy += vec_counters.at("rank_active_cycles")[i] *
+                      config_.act_stb_energy_inc +
+                  vec_counters.at("all_bank_idle_cycles")[i] *
+                      config_.pre_stb_energy_inc +
+                  vec_counters.at("sref_cycles")[i] * config_.sref_energy_inc;
+    }
+    snap.total_energy = energy;
+    snap.average_power = cycles == 0 ? 0.0 : energy / cycles;
+}
+
+void SimpleStats::MergeHistogram(const std::string& name,
+                                 LogLinearHistogram& histo) const {
+    histo.Merge(histo_counts_.at(name));
+    histo.Merge(epoch_histo_counts_.at(name));
+}
+
+void SimpleStats::BeginSampleWindow() {
+    for (auto name : {"num_cycles", "num_reads_done", "num_writes_done",
+                      "num_read_cmds", "num_write_cmds", "num_read_row_hits",
+                      "num_write_row_hits", "num_row_prefetch_reads"}) {
+        sample_start_[name] = TotalCount(name);
+    }
+    sample_start_["source_read_latency"] = TotalVecCount("source_read_latency");
+}
+
+void SimpleStats::EndSampleWindow() {
+    auto delta = [this](const std::string& name) {
+        return TotalCount(name) - sample_start_[name];
+    };
+    uint64_t cycles = delta("num_cycles");
+    if (cycles == 0) {
+        return;
+    }
+    uint64_t reads = delta("num_reads_done");
+    uint64_t reqs = reads + delta("num_writes_done");
+    sample_metrics_["sampled_bandwidth"].Add(
+        reqs * config_.request_size_bytes / (cycles * config_.tCK));
+    if (reads > 0) {
+        uint64_t latency = TotalVecCount("source_read_latency") -
+                           sample_start_["source_read_latency"];
+        sample_metrics_["sampled_read_latency"].Add(
+            static_cast<double>(latency) / reads);
+    }
+    // row prefetch READs count for energy but not for the demand hit rate
+    uint64_t cas = delta("num_read_cmds") + delta("num_write_cmds") -
+                   delta("num_row_prefetch_reads");
+    if (cas > 0) {
+        uint64_t hits =
+            delta("num_read_row_hits") + delta("num_write_row_hits");
+        sample_metrics_["sampled_row_hit_rate"].Add(
+            static_cast<double>(hits) / cas);
+    }
+}
+
+void SimpleStats::UpdateSampleStats() {
+    if (config_.sample_window == 0) {
+        return;
+    }
+    // every measured window has a bandwidth sample
+    calculated_["sample_windows"] = sample_metrics_["sampled_bandwidth"].n;
+    for (auto name : {"sampled_bandwidth", "sampled_read_latency",
+                      "sampled_row_hit_rate"}) {
+        const auto& metric = sample_metrics_[name];
+        calculated_[name] = metric.Mean();
+        calculated_[std::string(name) + "_ci95"] = metric.CI95();
     }
 }
 
+void SimpleStats::AddValue(const std::string name, const int value) {
+    epoch_histo_counts_[name].Record(value < 0 ? 0 : value);
+}
+
 std::string SimpleStats::GetTextHeader(bool is_final) const {
     std::string header =
         "###########################################\n## Statistics of "
@@ -262,13 +628,87 @@ void SimpleStats::Reset() {
         it.second = 0.0;
     }
     for (auto& it : histo_counts_) {
-        it.second.clear();
+        it.second.Clear();
     }
     for (auto& it : epoch_histo_counts_) {
-        it.second.clear();
+        it.second.Clear();
+    }
+    sample_start_.clear();
+    sample_metrics_.clear();
+}
+
+// writes all of stats, restores only names already in stats
+template <typename T>
+static void SerializeByName(Checkpoint& ckpt,
+                            std::unordered_map<std::string, T>& stats) {
+    if (!ckpt.Restoring()) {
+        ckpt.Field(stats);
+        return;
+    }
+    std::unordered_map<std::string, T> saved;
+    ckpt.Field(saved);
+    for (auto& it : saved) {
+        auto stat = stats.find(it.first);
+        if (stat != stats.end()) {
+            stat->second = it.second;
+        }
+    }
+}
+
+static void SerializeByName(
+    Checkpoint& ckpt,
+    std::unordered_map<std::string, LogLinearHistogram>& stats) {
+    uint64_t size = stats.size();
+    ckpt.Field(size);
+    if (!ckpt.Restoring()) {
+        for (auto& it : stats) {
+            std::string name = it.first;
+            ckpt.Field(name);
+            it.second.Serialize(ckpt);
+        }
+        return;
+    }
+    for (uint64_t i = 0; i < size; i++) {
+        std::string name;
+        ckpt.Field(name);
+        LogLinearHistogram histo;
+        histo.Serialize(ckpt);
+        auto stat = stats.find(name);
+        if (stat != stats.end()) {
+            stat->second = histo;
+        }
     }
 }
 
+// vectors must also keep their length
+static void SerializeByName(Checkpoint& ckpt,
+                            std::unordered_map<std::string,
+                                               std::vector<uint64_t> >& stats) {
+    if (!ckpt.Restoring()) {
+        ckpt.Field(stats);
+        return;
+    }
+    std::unordered_map<std::string, std::vector<uint64_t> > saved;
+    ckpt.Field(saved);
+    for (auto& it : saved) {
+        auto stat = stats.find(it.first);
+        if (stat != stats.end() && stat->second.size() == it.second.size()) {
+            stat->second = it.second;
+        }
+    }
+}
+
+void SimpleStats::Serialize(Checkpoint& ckpt) {
+    SerializeByName(ckpt, counters_);
+    SerializeByName(ckpt, epoch_counters_);
+    SerializeByName(ckpt, vec_counters_);
+    SerializeByName(ckpt, epoch_vec_counters_);
+    SerializeByName(ckpt, histo_counts_);
+    SerializeByName(ckpt, epoch_histo_counts_);
+    ckpt.Field(sample_start_);
+    ckpt.Field(sample_metrics_);
+}
+
 void SimpleStats::InitStat(std::string name, std::string stat_type,
                            std::string description) {
     header_descs_.emplace(name, description);
@@ -304,8 +744,8 @@ void SimpleStats::InitHistoStat(std::string name, std::string description,
     int bin_width = (end_val - start_val) / num_bins;
     bin_widths_.emplace(name, bin_width);
     histo_bounds_.emplace(name, std::make_pair(start_val, end_val));
-    histo_counts_.emplace(name, std::unordered_map<int, uint64_t>());
-    epoch_histo_counts_.emplace(name, std::unordered_map<int, uint64_t>());
+    histo_counts_.emplace(name, LogLinearHistogram());
+    epoch_histo_counts_.emplace(name, LogLinearHistogram());
 
     // initialize headers, descriptions
     std::vector<std::string> headers;
@@ -346,34 +786,29 @@ void SimpleStats::UpdateHistoBins() {
         const auto& name = name_bins.first;
         auto& bins = name_bins.second;
         std::fill(bins.begin(), bins.end(), 0);
-        for (const auto it : epoch_histo_counts_[name]) {
-            int value = it.first;
-            uint64_t count = it.second;
-            int bin_idx = 0;
-            if (value < histo_bounds_[name].first) {
-                bin_idx = 0;
-            } else if (value > histo_bounds_[name].second) {
-                bin_idx = bins.size() - 1;
-            } else {
-                bin_idx =
-                    (value - histo_bounds_[name].first) / bin_widths_[name] + 1;
-            }
-            bins[bin_idx] += count;
-        }
+        // a bucket goes to the bin of its lowest value, buckets are exact
+        // below 128 and 2 wide up to 255 so even bin edges stay exact
+        epoch_histo_counts_[name].ForEachBucket(
+            [&](uint64_t low, uint64_t high, uint64_t count) {
+                int value = static_cast<int>(low);
+                int bin_idx = 0;
+                if (value < histo_bounds_[name].first) {
+                    bin_idx = 0;
+                } else if (value > histo_bounds_[name].second) {
+                    bin_idx = bins.size() - 1;
+                } else {
+                    bin_idx = (value - histo_bounds_[name].first) /
+                                  bin_widths_[name] +
+                              1;
+                }
+                bins[bin_idx] += count;
+            });
     }
 
     // update overall histogram counts based on epoch histo counts
     for (auto& name_counts : epoch_histo_counts_) {
         const auto& name = name_counts.first;
-        auto& epoch_counts = name_counts.second;
-        auto& final_counts = histo_counts_[name];
-        for (const auto& val_cnt : epoch_counts) {
-            if (final_counts.count(val_cnt.first) <= 0) {
-                final_counts[val_cnt.first] = val_cnt.second;
-            } else {
-                final_counts[val_cnt.first] += val_cnt.second;
-            }
-        }
+        histo_counts_[name].Merge(name_counts.second);
         auto& final_bins = histo_bins_[name];
         for (size_t i = 0; i < final_bins.size(); i++) {
             final_bins[i] += epoch_histo_bins_[name][i];
@@ -381,18 +816,6 @@ void SimpleStats::UpdateHistoBins() {
     }
 }
 
-double SimpleStats::GetHistoAvg(const HistoCount& hist_counts) const {
-    uint64_t accu_sum = 0;
-    uint64_t count = 0;
-    for (auto i = hist_counts.begin(); i != hist_counts.end(); i++) {
-        accu_sum += i->first * i->second;
-        count += i->second;
-    }
-    return count == 0
-               ? 0.0
-               : static_cast<double>(accu_sum) / static_cast<double>(count);
-}
-
 void SimpleStats::UpdatePrints(bool epoch) {
     j_data_["channel"] = channel_id_;
 
@@ -429,9 +852,10 @@ void SimpleStats::UpdatePrints(bool epoch) {
     if (!epoch) {
         for (const auto& name_hist : histo_counts_) {
             Json j_list;
-            for (const auto& it : name_hist.second) {
-                j_list[std::to_string(it.first)] = it.second;
-            }
+            name_hist.second.ForEachBucket(
+                [&](uint64_t low, uint64_t high, uint64_t count) {
+                    j_list[std::to_string(low)] = count;
+                });
             j_data_[name_hist.first] = j_list;
         }
     }
@@ -456,6 +880,89 @@ void SimpleStats::UpdatePrints(bool epoch) {
     }
 }
 
+void SimpleStats::UpdateTailStats(const HistoCount& latency_counts) {
+    calculated_["p50_read_latency"] = latency_counts.Percentile(0.5);
+    calculated_["p95_read_latency"] = latency_counts.Percentile(0.95);
+    calculated_["p99_read_latency"] = latency_counts.Percentile(0.99);
+    calculated_["p999_read_latency"] = latency_counts.Percentile(0.999);
+    calculated_["p9999_read_latency"] = latency_counts.Percentile(0.9999);
+    calculated_["max_read_latency"] = latency_counts.Max();
+}
+
+void SimpleStats::UpdateSourceStats(const VecStat& ref_vcounters,
+                                    uint64_t num_cycles) {
+    double total_time = num_cycles * config_.tCK;
+    const auto& cas = ref_vcounters.at("source_cas_cmds");
+    for (int i = 0; i < config_.num_sources; i++) {
+        vec_doubles_["source_bandwidth"][i] =
+            total_time > 0.0
+                ? cas[i] * config_.request_size_bytes / total_time
+                : 0.0;
+    }
+
+    // slowdown is measured against an unloaded closed-bank read
+    double alone_latency = config_.tRCD + config_.read_delay;
+    const auto& reads = ref_vcounters.at("source_reads_done");
+    const auto& latency = ref_vcounters.at("source_read_latency");
+    double max_slowdown = 0.0;
+    double min_slowdown = 0.0;
+    for (int i = 0; i < config_.num_sources; i++) {
+        double avg = reads[i] == 0 ? 0.0
+                                   : static_cast<double>(latency[i]) / reads[i];
+        double slowdown = avg / alone_latency;
+        vec_doubles_["source_avg_read_latency"][i] = avg;
+        vec_doubles_["source_slowdown"][i] = slowdown;
+        if (reads[i] == 0) {
+            continue;
+        }
+        max_slowdown = std::max(max_slowdown, slowdown);
+        if (min_slowdown == 0.0 || slowdown < min_slowdown) {
+            min_slowdown = slowdown;
+        }
+    }
+    calculated_["max_source_slowdown"] = max_slowdown;
+    calculated_["source_unfairness"] =
+        min_slowdown > 0.0 ? max_slowdown / min_slowdown : 0.0;
+}
+
+void SimpleStats::UpdateRowPrefetchStats(
+    std::unordered_map<std::string, uint64_t>& ref_counters) {
+    uint64_t reads = ref_counters["num_row_prefetch_reads"];
+    uint64_t reads_done = ref_counters["num_reads_done"];
+    calculated_["row_prefetch_accuracy"] =
+        reads == 0 ? 0.0
+                   : static_cast<double>(ref_counters["row_prefetch_useful"]) /
+                         reads;
+    calculated_["row_prefetch_coverage"] =
+        reads_done == 0
+            ? 0.0
+            : static_cast<double>(ref_counters["row_prefetch_hits"]) /
+                  reads_done;
+}
+
+void SimpleStats::UpdateQoSStats(
+    const VecStat& ref_vcounters,
+    const std::unordered_map<std::string, HistoCount>& ref_histo_counts) {
+    const auto& reads = ref_vcounters.at("qos_reads_done");
+    const auto& latency = ref_vcounters.at("qos_read_latency");
+    for (int i = 0; i < config_.num_qos_classes; i++) {
+        vec_doubles_["qos_avg_read_latency"][i] =
+            reads[i] == 0 ? 0.0 : static_cast<double>(latency[i]) / reads[i];
+        vec_doubles_["qos_p99_read_latency"][i] =
+            ref_histo_counts.at(qos_latency_names_[i]).Percentile(0.99);
+    }
+}
+
+void SimpleStats::UpdateDuelStats(const VecStat& ref_vcounters) {
+    const auto& reads = ref_vcounters.at("duel_leader_reads");
+    const auto& latency = ref_vcounters.at("duel_leader_latency");
+    auto& avg = vec_doubles_["duel_leader_avg_latency"];
+    for (size_t i = 0; i < avg.size(); i++) {
+        avg[i] =
+            reads[i] == 0 ? 0.0 : static_cast<double>(latency[i]) / reads[i];
+    }
+}
+
 void SimpleStats::UpdateEpochStats() {
     // push counter values as is
     UpdateCounters();
@@ -471,6 +978,12 @@ void SimpleStats::UpdateEpochStats() {
         epoch_counters_["num_ref_cmds"] * config_.ref_energy_inc;
     doubles_["refb_energy"] =
         epoch_counters_["num_refb_cmds"] * config_.refb_energy_inc;
+    doubles_["row_prefetch_energy"] =
+        epoch_counters_["num_row_prefetch_reads"] * config_.read_energy_inc;
+    doubles_["spec_act_energy"] =
+        epoch_counters_["spec_acts"] * config_.act_energy_inc;
+    doubles_["spec_act_wasted_energy"] =
+        epoch_counters_["spec_act_misses"] * config_.act_energy_inc;
 
     // vector doubles, update first, then push
     double background_energy = 0.0;
@@ -502,9 +1015,21 @@ void SimpleStats::UpdateEpochStats() {
     calculated_["total_energy"] = total_energy;
     calculated_["average_power"] = total_energy / epoch_counters_["num_cycles"];
     calculated_["average_read_latency"] =
-        GetHistoAvg(epoch_histo_counts_.at("read_latency"));
+        epoch_histo_counts_.at("read_latency").Mean();
+    calculated_["average_demand_read_latency"] =
+        epoch_histo_counts_.at("demand_read_latency").Mean();
+    UpdateRowPrefetchStats(epoch_counters_);
+    calculated_["prefetch_row_hit_rate"] =
+        epoch_counters_["num_prefetch_cmds"] == 0
+            ? 0.0
+            : static_cast<double>(epoch_counters_["num_prefetch_row_hits"]) /
+                  epoch_counters_["num_prefetch_cmds"];
     calculated_["average_interarrival"] =
-        GetHistoAvg(epoch_histo_counts_.at("interarrival_latency"));
+        epoch_histo_counts_.at("interarrival_latency").Mean();
+    UpdateSourceStats(epoch_vec_counters_, epoch_counters_["num_cycles"]);
+    UpdateQoSStats(epoch_vec_counters_, epoch_histo_counts_);
+    UpdateDuelStats(epoch_vec_counters_);
+    UpdateTailStats(epoch_histo_counts_.at("read_latency"));
 
     // Queue occupancy ratio calculation
     uint64_t num_cycles = epoch_counters_["num_cycles"];
@@ -517,6 +1042,10 @@ void SimpleStats::UpdateEpochStats() {
             static_cast<double>(epoch_counters_["trans_queue_full_cycles"]) / num_cycles;
         calculated_["trans_queue_empty_ratio"] =
             static_cast<double>(epoch_counters_["trans_queue_empty_cycles"]) / num_cycles;
+        calculated_["data_bus_utilization"] =
+            static_cast<double>(epoch_counters_["num_read_cmds"] +
+                                epoch_counters_["num_write_cmds"]) *
+            config_.burst_cycle / num_cycles;
     }
 
     UpdatePrints(true);
@@ -527,7 +1056,7 @@ void SimpleStats::UpdateEpochStats() {
         std::fill(vec.second.begin(), vec.second.end(), 0);
     }
     for (auto& it : epoch_histo_counts_) {
-        it.second.clear();
+        it.second.Clear();
     }
     return;
 }
@@ -544,6 +1073,11 @@ void SimpleStats::UpdateFinalStats() {
     doubles_["ref_energy"] = counters_["num_ref_cmds"] * config_.ref_energy_inc;
     doubles_["refb_energy"] =
         counters_["num_refb_cmds"] * config_.refb_energy_inc;
+    doubles_["row_prefetch_energy"] =
+        counters_["num_row_prefetch_reads"] * config_.read_energy_inc;
+    doubles_["spec_act_energy"] = counters_["spec_acts"] * config_.act_energy_inc;
+    doubles_["spec_act_wasted_energy"] =
+        counters_["spec_act_misses"] * config_.act_energy_inc;
 
     // vector doubles, update first, then push
     double background_energy = 0.0;
@@ -577,9 +1111,22 @@ void SimpleStats::UpdateFinalStats() {
     calculated_["average_power"] = total_energy / counters_["num_cycles"];
     // calculated_["average_read_latency"] = GetHistoAvg("read_latency");
     calculated_["average_read_latency"] =
-        GetHistoAvg(histo_counts_.at("read_latency"));
+        histo_counts_.at("read_latency").Mean();
+    calculated_["average_demand_read_latency"] =
+        histo_counts_.at("demand_read_latency").Mean();
+    UpdateRowPrefetchStats(counters_);
+    calculated_["prefetch_row_hit_rate"] =
+        counters_["num_prefetch_cmds"] == 0
+            ? 0.0
+            : static_cast<double>(counters_["num_prefetch_row_hits"]) /
+                  counters_["num_prefetch_cmds"];
     calculated_["average_interarrival"] =
-        GetHistoAvg(histo_counts_.at("interarrival_latency"));
+        histo_counts_.at("interarrival_latency").Mean();
+    UpdateSourceStats(vec_counters_, counters_["num_cycles"]);
+    UpdateQoSStats(vec_counters_, histo_counts_);
+    UpdateDuelStats(vec_counters_);
+    UpdateTailStats(histo_counts_.at("read_latency"));
+    UpdateSampleStats();
 
     // Queue occupancy ratio calculation
     uint64_t total_cycles = counters_["num_cycles"];
@@ -592,6 +1139,10 @@ void SimpleStats::UpdateFinalStats() {
             static_cast<double>(counters_["trans_queue_full_cycles"]) / total_cycles;
         calculated_["trans_queue_empty_ratio"] =
             static_cast<double>(counters_["trans_queue_empty_cycles"]) / total_cycles;
+        calculated_["data_bus_utilization"] =
+            static_cast<double>(counters_["num_read_cmds"] +
+                                counters_["num_write_cmds"]) *
+            config_.burst_cycle / total_cycles;
     }
 
     UpdatePrints(false);
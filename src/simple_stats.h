@@ -6,14 +6,36 @@
 #include <unordered_map>
 #include <vector>
 
+#include "checkpoint.h"
 #include "configuration.h"
+#include "histogram.h"
 #include "json.hpp"
 
 namespace dramsim3 {
 
+// Running mean and variance of one metric over sampled windows
+struct SampleMetric {
+    uint64_t n = 0;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    void Add(double val) {
+        n++;
+        sum += val;
+        sum_sq += val * val;
+    }
+    double Mean() const { return n == 0 ? 0.0 : sum / n; }
+    // half width of the 95% confidence interval of the mean
+    double CI95() const;
+};
+
 class SimpleStats {
    public:
     SimpleStats(const Config& config, int channel_id);
+    // the per read slots point into the stat maps, which keep their nodes
+    // when moved but not when copied
+    SimpleStats(const SimpleStats&) = delete;
+    SimpleStats& operator=(const SimpleStats&) = delete;
+    SimpleStats(SimpleStats&&) = default;
     // incrementing counter
     void Increment(const std::string name) { epoch_counters_[name] += 1; }
 
@@ -30,6 +52,23 @@ class SimpleStats {
     // add historgram value
     void AddValue(const std::string name, const int value);
 
+    // per source and QoS class counts and latency of a finished read, on
+    // slots looked up once instead of by name for every read
+    void AddReadDone(int source_id, int qos_class, uint64_t latency) {
+        (*source_reads_done_)[source_id] += 1;
+        (*source_read_latency_)[source_id] += latency;
+        (*qos_reads_done_)[qos_class] += 1;
+        (*qos_read_latency_)[qos_class] += latency;
+        qos_latency_histos_[qos_class]->Record(latency);
+    }
+
+    // cycles since the last touch of a row, log2 sized buckets
+    void AddRowHitDistance(uint64_t distance);
+
+    // sampled simulation, measures the detailed window between the calls
+    void BeginSampleWindow();
+    void EndSampleWindow();
+
     // return per rank background energy
     double RankBackgroundEnergy(const int r) const;
 
@@ -39,12 +78,22 @@ class SimpleStats {
     // Final statas output
     void PrintFinalStats();
 
+    // totals so far, leaves the epoch state untouched
+    void Snapshot(ChannelStatsSnapshot& snap) const;
+    // adds the totals of histogram name to histo
+    void MergeHistogram(const std::string& name,
+                        LogLinearHistogram& histo) const;
+
     // Reset (usually after one phase of simulation)
     void Reset();
 
+    // counters and histograms, restored by name so stats the restoring
+    // config does not have are dropped and new ones start from zero
+    void Serialize(Checkpoint& ckpt);
+
    private:
     using VecStat = std::unordered_map<std::string, std::vector<uint64_t> >;
-    using HistoCount = std::unordered_map<int, uint64_t>;
+    using HistoCount = LogLinearHistogram;
     using Json = nlohmann::json;
     void InitStat(std::string name, std::string stat_type,
                   std::string description);
@@ -57,13 +106,39 @@ class SimpleStats {
     void UpdateCounters();
     void UpdateHistoBins();
     void UpdatePrints(bool epoch);
-    double GetHistoAvg(const HistoCount& histo_counts) const;
+    void UpdateTailStats(const HistoCount& latency_counts);
     std::string GetTextHeader(bool is_final) const;
+    void UpdateSourceStats(const VecStat& ref_vcounters, uint64_t num_cycles);
+    void UpdateRowPrefetchStats(
+        std::unordered_map<std::string, uint64_t>& ref_counters);
+    void UpdateQoSStats(const VecStat& ref_vcounters,
+                        const std::unordered_map<std::string, HistoCount>&
+                            ref_histo_counts);
+    void UpdateDuelStats(const VecStat& ref_vcounters);
+    uint64_t TotalCount(const std::string& name) const;
+    uint64_t TotalVecCount(const std::string& name) const;
+    void UpdateSampleStats();
     void UpdateEpochStats();
     void UpdateFinalStats();
 
     const Config& config_;
     int channel_id_;
+    std::vector<std::string> qos_latency_names_;  // histogram per QoS class
+    // epoch stats AddReadDone updates
+    std::vector<uint64_t>* source_reads_done_;
+    std::vector<uint64_t>* source_read_latency_;
+    std::vector<uint64_t>* qos_reads_done_;
+    std::vector<uint64_t>* qos_read_latency_;
+    std::vector<HistoCount*> qos_latency_histos_;
+    // row hit distance buckets: [base * (2^i - 1), base * (2^(i+1) - 1)),
+    // cut at max, the last bucket collects distances >= max
+    uint64_t row_hit_distance_base_;
+    uint64_t row_hit_distance_max_;
+    int row_hit_distance_buckets_;
+    // counter totals at the start of the current sample window
+    std::unordered_map<std::string, uint64_t> sample_start_;
+    // per window bandwidth, read latency and row hit rate
+    std::unordered_map<std::string, SampleMetric> sample_metrics_;
 
     // map names to descriptions
     std::unordered_map<std::string, std::string> header_descs_;
@@ -86,7 +161,8 @@ class SimpleStats {
     // calculated stats, similar to double, but not the same
     std::unordered_map<std::string, double> calculated_;
 
-    // histogram stats
+    // histogram stats, log-linear counts for averages and percentiles and
+    // the fixed bins of the configured bounds for the printed output
     std::unordered_map<std::string, std::vector<std::string> > histo_headers_;
 
     std::unordered_map<std::string, std::pair<int, int> > histo_bounds_;
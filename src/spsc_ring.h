@@ -0,0 +1,55 @@
+#ifndef __SPSC_RING_H
+#define __SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace dramsim3 {
+
+// Bounded lock-free queue between exactly one producer and one consumer
+// thread. The capacity is rounded up to a power of two, each side only
+// writes its own index so the two never contend on a cache line.
+template <typename T>
+class SPSCRing {
+   public:
+    explicit SPSCRing(size_t capacity) : head_(0), tail_(0) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buf_.resize(size);
+        mask_ = size - 1;
+    }
+
+    // producer side, false if the ring is full
+    bool TryPush(const T& val) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) {
+            return false;
+        }
+        buf_[tail & mask_] = val;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, false if the ring is empty
+    bool TryPop(T& val) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        val = buf_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+   private:
+    std::vector<T> buf_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_;  // next to pop
+    alignas(64) std::atomic<size_t> tail_;  // next to push
+};
+
+}  // namespace dramsim3
+#endif
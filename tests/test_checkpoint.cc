@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+#include "catch.hpp"
+#include "checkpoint.h"
+#include "memory_system.h"
+
+namespace {
+
+using DoneList = std::vector<std::pair<uint64_t, uint64_t>>;
+
+// random reads and writes at full speed, as RandomCPU does
+void Drive(dramsim3::MemorySystem& mem, std::mt19937_64& gen, uint64_t& clk,
+           int cycles) {
+    for (int i = 0; i < cycles; i++) {
+        mem.ClockTick();
+        uint64_t addr = gen();
+        bool is_write = gen() % 3 == 0;
+        if (mem.WillAcceptTransaction(addr, is_write)) {
+            mem.AddTransaction(addr, is_write);
+        }
+        clk++;
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Checkpoint blocks", "[checkpoint]") {
+    const char* file_name = "test_blocks.ckpt";
+    int a = 1, b = 2, c = 3;
+    std::vector<int> vec = {4, 5, 6};
+    {
+        dramsim3::Checkpoint ckpt(file_name, false);
+        ckpt.Field(a);
+        ckpt.Block("kept", [&] { ckpt.Field(b); });
+        ckpt.Block("skipped", [&] { ckpt.Field(vec); });
+        ckpt.Field(c);
+    }
+    a = b = c = 0;
+    vec.clear();
+    dramsim3::Checkpoint ckpt(file_name, true);
+    ckpt.Field(a);
+    REQUIRE(ckpt.Block("kept", [&] { ckpt.Field(b); }));
+    REQUIRE_FALSE(ckpt.Block("other", [&] { ckpt.Field(vec); }));
+    ckpt.Field(c);
+    REQUIRE(a == 1);
+    REQUIRE(b == 2);
+    REQUIRE(c == 3);
+    REQUIRE(vec.empty());
+    std::remove(file_name);
+}
+
+TEST_CASE("Restored memory system continues the same run", "[checkpoint]") {
+    const char* config_file = "configs/DDR4_8Gb_x8_3200.ini";
+    const char* file_name = "test_memory.ckpt";
+    DoneList done_a, done_b;
+    uint64_t clk_a = 0, clk_b = 0;
+    dramsim3::MemorySystem mem_a(
+        config_file, ".",
+        [&](uint64_t addr) { done_a.emplace_back(addr, clk_a); },
+        [&](uint64_t addr) { done_a.emplace_back(addr, clk_a); });
+    dramsim3::MemorySystem mem_b(
+        config_file, ".",
+        [&](uint64_t addr) { done_b.emplace_back(addr, clk_b); },
+        [&](uint64_t addr) { done_b.emplace_back(addr, clk_b); });
+
+    std::mt19937_64 gen_a(1);
+    Drive(mem_a, gen_a, clk_a, 20000);
+    mem_a.Save(file_name);
+    mem_b.Restore(file_name);
+    std::remove(file_name);
+
+    // both continue from the same requests in flight
+    std::mt19937_64 gen_b = gen_a;
+    done_a.clear();
+    clk_a = 0;
+    Drive(mem_a, gen_a, clk_a, 20000);
+    Drive(mem_b, gen_b, clk_b, 20000);
+    REQUIRE(!done_a.empty());
+    REQUIRE(done_a == done_b);
+}
@@ -1,4 +1,8 @@
 #define CATCH_CONFIG_MAIN
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include "catch.hpp"
 #include "configuration.h"
 
@@ -93,3 +97,41 @@ TEST_CASE("Address Mapping", "[config]") {
     }
 }
 
+
+TEST_CASE("Row hit cap keys are kept consistent", "[config]") {
+    // DDR4 config with extra [system] keys
+    auto load = [](const std::string& keys) {
+        std::ifstream base("configs/DDR4_8Gb_x8_3200.ini");
+        std::stringstream text;
+        text << base.rdbuf();
+        std::string ini = text.str();
+        ini.insert(ini.find("[system]") + 9, keys);
+        const char* ini_name = "test_row_hit_cap.ini";
+        std::ofstream(ini_name) << ini;
+        dramsim3::Config config(ini_name, ".");
+        std::remove(ini_name);
+        return config;
+    };
+
+    SECTION("Inverted bounds are clamped") {
+        auto config = load(
+            "adaptive_row_hit_cap = true\nrow_hit_cap_min = 8\n"
+            "row_hit_cap_max = 2\n");
+        REQUIRE(config.row_hit_cap_min == 2);
+        REQUIRE(config.row_hit_cap_max == 2);
+        REQUIRE(config.row_hit_cap == 2);
+    }
+
+    SECTION("Adaptive start value is clamped into the bounds") {
+        auto config = load(
+            "adaptive_row_hit_cap = true\nrow_hit_cap = 40\n"
+            "row_hit_cap_min = 0\n");
+        REQUIRE(config.row_hit_cap_min == 1);
+        REQUIRE(config.row_hit_cap == config.row_hit_cap_max);
+    }
+
+    SECTION("A fixed cap may lie outside the adaptive bounds") {
+        auto config = load("row_hit_cap = 40\n");
+        REQUIRE(config.row_hit_cap == 40);
+    }
+}
@@ -0,0 +1,524 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "catch.hpp"
+#include "configuration.h"
+#include "controller.h"
+
+namespace {
+uint64_t MakeAddr(const dramsim3::Config& config, int bankgroup, int bank,
+                  int row, int col) {
+    return config.GetHexAddress(
+        dramsim3::Address(0, 0, bankgroup, bank, row, col));
+}
+
+uint64_t Counter(const dramsim3::Controller& ctrl, const std::string& name) {
+    dramsim3::ChannelStatsSnapshot snap;
+    ctrl.GetStatsSnapshot(snap);
+    return snap.counters.at(name);
+}
+
+// ticks the controller, finished transactions are thrown away
+void Run(dramsim3::Controller& ctrl, int cycles) {
+    dramsim3::Transaction done;
+    for (int i = 0; i < cycles; i++) {
+        while (ctrl.ReturnDoneTrans(ctrl.clk_, done) >= 0) {
+        }
+        ctrl.ClockTick();
+    }
+}
+}  // namespace
+
+TEST_CASE("Write drain starts and stops at the watermarks", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.write_drain_high_watermark = 0.5;
+    config.write_drain_low_watermark = 0.25;
+    // no idle drains, only the high watermark starts a burst
+    config.write_drain_idle_watermark = 1.0;
+    dramsim3::Timing timing(config);
+    dramsim3::Controller ctrl(0, config, timing);
+    size_t cap = ctrl.write_buffer().capacity();
+    size_t high = cap / 2;
+    size_t low = cap / 4;
+    int queued = 0;
+    auto add_write = [&]() {
+        uint64_t addr = MakeAddr(config, queued % config.bankgroups, 0,
+                                 queued, 0);
+        queued++;
+        ctrl.AddTransaction(dramsim3::Transaction(addr, true));
+    };
+
+    while (ctrl.write_buffer().size() + 1 < high) {
+        add_write();
+    }
+    Run(ctrl, 500);
+    REQUIRE(ctrl.write_draining_ == 0);
+    REQUIRE(ctrl.write_buffer().size() == high - 1);
+
+    add_write();
+    Run(ctrl, 1);
+    REQUIRE(ctrl.write_draining_ > 0);
+    REQUIRE(Counter(ctrl, "num_write_drains") == 1);
+
+    // the burst ends at the low watermark and nothing starts a new one
+    Run(ctrl, 2000);
+    REQUIRE(ctrl.write_draining_ == 0);
+    REQUIRE(ctrl.write_buffer().size() == low);
+    REQUIRE(Counter(ctrl, "num_write_drains") == 1);
+}
+
+TEST_CASE("Several transactions move per cycle, open rows first",
+          "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    dramsim3::Timing timing(config);
+
+    SECTION("trans_per_cycle transactions go to the bank queues") {
+        for (int per_cycle : {1, 4}) {
+            config.trans_per_cycle = per_cycle;
+            dramsim3::Controller ctrl(0, config, timing);
+            for (int bank = 0; bank < 4; bank++) {
+                ctrl.AddTransaction(dramsim3::Transaction(
+                    MakeAddr(config, 0, bank, 1, 0), false));
+            }
+            ctrl.ScheduleTransaction();
+            REQUIRE(ctrl.read_queue().size() == 4u - per_cycle);
+            REQUIRE(ctrl.cmd_queue_.QueueUsage() == per_cycle);
+        }
+    }
+
+    SECTION("A read to the open row is taken from inside the window") {
+        // row 1 of bank 0 is open, then a conflict, a closed bank and a hit
+        // arrive in that order
+        auto first_pick = [&](int window) {
+            config.row_hit_first_window = window;
+            dramsim3::Controller ctrl(0, config, timing);
+            ctrl.AddTransaction(dramsim3::Transaction(
+                MakeAddr(config, 0, 0, 1, 0), false));
+            Run(ctrl, 200);
+            for (auto bank_row : {std::make_pair(0, 2), std::make_pair(1, 5),
+                                  std::make_pair(0, 1)}) {
+                ctrl.AddTransaction(dramsim3::Transaction(
+                    MakeAddr(config, 0, bank_row.first, bank_row.second, 1),
+                    false));
+            }
+            ctrl.ScheduleTransaction();
+            REQUIRE(ctrl.read_queue().size() == 2);
+            uint64_t promoted = Counter(ctrl, "num_trans_row_hit_promoted");
+            // the oldest read left behind tells which one was taken
+            return std::make_pair(ctrl.read_queue().front().addr, promoted);
+        };
+        uint64_t conflict = MakeAddr(config, 0, 0, 2, 1);
+        uint64_t closed = MakeAddr(config, 0, 1, 5, 1);
+        // FCFS takes the conflict, the closed bank is next in line
+        REQUIRE(first_pick(0) == std::make_pair(closed, uint64_t(0)));
+        // the hit is promoted past both, the conflict stays first in line
+        REQUIRE(first_pick(4) == std::make_pair(conflict, uint64_t(1)));
+        // a window of two does not reach the hit
+        REQUIRE(first_pick(2) == std::make_pair(closed, uint64_t(0)));
+    }
+}
+
+TEST_CASE("Back-to-back CAS pairs by bank group", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    dramsim3::Timing timing(config);
+    dramsim3::Controller ctrl(0, config, timing);
+    // two reads to one bank group, then one to the next bank group
+    for (int col = 0; col < 2; col++) {
+        uint64_t addr = MakeAddr(config, 0, 0, 1, col);
+        ctrl.AddTransaction(dramsim3::Transaction(addr, false));
+    }
+    Run(ctrl, 200);
+    REQUIRE(Counter(ctrl, "num_read_cmds") == 2);
+    REQUIRE(Counter(ctrl, "num_cas_pairs_tccd_l") == 1);
+    REQUIRE(Counter(ctrl, "num_cas_pairs_tccd_s") == 0);
+
+    uint64_t addr = MakeAddr(config, 1, 0, 1, 0);
+    ctrl.AddTransaction(dramsim3::Transaction(addr, false));
+    Run(ctrl, 200);
+    REQUIRE(Counter(ctrl, "num_read_cmds") == 3);
+    REQUIRE(Counter(ctrl, "num_cas_pairs_tccd_l") == 1);
+    REQUIRE(Counter(ctrl, "num_cas_pairs_tccd_s") == 1);
+}
+
+TEST_CASE("Bank group interleaving only picks CAS commands",
+          "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.bankgroup_interleave = true;
+    dramsim3::Timing timing(config);
+    dramsim3::Controller ctrl(0, config, timing);
+    // a steady mix of hits and conflicts over two bank groups, the pick only
+    // happens when the round robin CAS and the other bank group line up
+    uint32_t seed = 1;
+    for (int cycle = 0; cycle < 20000; cycle++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t r = seed >> 16;
+        uint64_t addr = MakeAddr(config, r % 2, (r >> 1) % 4, (r >> 3) % 4,
+                                 (r >> 5) % 32);
+        if (ctrl.WillAcceptTransaction(addr, false)) {
+            ctrl.AddTransaction(dramsim3::Transaction(addr, false));
+        }
+        Run(ctrl, 1);
+    }
+    Run(ctrl, 2000);
+    uint64_t picks = Counter(ctrl, "num_bg_interleave_picks");
+    REQUIRE(picks > 0);
+    // every pick is a CAS that pairs with the previous one at tCCD_S
+    REQUIRE(picks <= Counter(ctrl, "num_cas_pairs_tccd_s"));
+}
+
+TEST_CASE("Proactive precharge closes idle rows", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.aggressive_precharging_enabled = true;
+    dramsim3::Timing timing(config);
+    dramsim3::Controller ctrl(0, config, timing);
+    auto& bank = ctrl.channel_state_.bank_states_[0][0][0];
+
+    ctrl.AddTransaction(
+        dramsim3::Transaction(MakeAddr(config, 0, 0, 1, 0), false));
+    Run(ctrl, 200);
+    // nothing else wants row 1, so it is closed without a demand
+    REQUIRE_FALSE(bank.IsRowOpen());
+    REQUIRE(Counter(ctrl, "num_pre_for_proactive") == 1);
+
+    // the next row opens without paying for a PRE
+    ctrl.AddTransaction(
+        dramsim3::Transaction(MakeAddr(config, 0, 0, 2, 0), false));
+    Run(ctrl, 200);
+    REQUIRE(Counter(ctrl, "num_ondemand_pres") == 0);
+    REQUIRE(Counter(ctrl, "num_pre_cmds") ==
+            Counter(ctrl, "num_pre_for_proactive"));
+    REQUIRE(Counter(ctrl, "num_proactive_pre_useful") == 1);
+    REQUIRE(Counter(ctrl, "num_proactive_pre_same_row") == 0);
+}
+
+TEST_CASE("Speculative ACT hits and misses", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.row_buf_policy = "CLOSE_PAGE";
+    config.speculative_act_enabled = true;
+    dramsim3::Timing timing(config);
+    // rows 1 and 2 take turns in bank 0, far enough apart for the bank to
+    // be closed and idle in between
+    auto run = [&](int timeout) {
+        config.speculative_act_timeout = timeout;
+        dramsim3::Controller ctrl(0, config, timing);
+        for (int i = 0; i < 20; i++) {
+            uint64_t addr = MakeAddr(config, 0, 0, 1 + i % 2, 0);
+            ctrl.AddTransaction(dramsim3::Transaction(addr, false));
+            Run(ctrl, 300);
+        }
+        dramsim3::ChannelStatsSnapshot snap;
+        ctrl.GetStatsSnapshot(snap);
+        return snap.counters;
+    };
+
+    // the predicted row is still open when the read arrives
+    auto held = run(1000);
+    REQUIRE(held.at("spec_acts") > 10);
+    REQUIRE(held.at("spec_act_hits") >= held.at("spec_acts") - 1);
+    REQUIRE(held.at("spec_act_misses") == 0);
+    REQUIRE(held.at("spec_act_timeouts") == 0);
+
+    // closed again before the read arrives, every speculation is wasted
+    auto timed_out = run(64);
+    REQUIRE(timed_out.at("spec_acts") > 10);
+    REQUIRE(timed_out.at("spec_act_hits") == 0);
+    REQUIRE(timed_out.at("spec_act_misses") ==
+            timed_out.at("spec_act_timeouts"));
+    REQUIRE(timed_out.at("spec_act_misses") >= timed_out.at("spec_acts") - 1);
+}
+
+TEST_CASE("Row prefetches serve reads but are no demand row hits",
+          "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.row_prefetch_enabled = true;
+    config.row_prefetch_degree = 3;
+    dramsim3::Timing timing(config);
+    dramsim3::Controller ctrl(0, config, timing);
+    auto in_buffer = [&](int col) {
+        uint64_t addr = MakeAddr(config, 0, 0, 1, col);
+        for (const auto& entry : ctrl.row_prefetch_buf_) {
+            if (entry.addr == addr) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // an idle bus reads the next lines of the row after a demand read
+    ctrl.AddTransaction(
+        dramsim3::Transaction(MakeAddr(config, 0, 0, 1, 0), false));
+    Run(ctrl, 300);
+    REQUIRE(Counter(ctrl, "num_read_cmds") == 4);
+    REQUIRE(Counter(ctrl, "num_row_prefetch_reads") == 3);
+    REQUIRE(Counter(ctrl, "num_read_row_hits") == 0);
+    REQUIRE(ctrl.channel_state_.RowHitCount(0, 0, 0) == 1);
+    REQUIRE(in_buffer(1));
+    REQUIRE(in_buffer(2));
+    REQUIRE(in_buffer(3));
+
+    // a read of a prefetched line never reaches the DRAM
+    ctrl.AddTransaction(
+        dramsim3::Transaction(MakeAddr(config, 0, 0, 1, 1), false));
+    Run(ctrl, 100);
+    REQUIRE(Counter(ctrl, "row_prefetch_hits") == 1);
+    REQUIRE(Counter(ctrl, "row_prefetch_useful") == 1);
+    REQUIRE(Counter(ctrl, "num_read_cmds") == 4);
+
+    // a write makes the prefetched copy stale
+    ctrl.AddTransaction(
+        dramsim3::Transaction(MakeAddr(config, 0, 0, 1, 2), true));
+    REQUIRE_FALSE(in_buffer(2));
+    REQUIRE(in_buffer(3));
+}
+
+TEST_CASE("Row hit cap adapts and aged requests close the row",
+          "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    dramsim3::Timing timing(config);
+    // keeps the transaction queue full of reads to bank 0, row_of(n) gives
+    // the row of the n-th read, returns when the read to watch finished
+    auto saturate = [&](dramsim3::Controller& ctrl, int cycles,
+                        std::function<int(int)> row_of, uint64_t watch) {
+        uint64_t watch_done = 0;
+        int n = 0;
+        dramsim3::Transaction done;
+        for (int clk = 0; clk < cycles; clk++) {
+            uint64_t addr = MakeAddr(config, 0, 0, row_of(n), n % 128);
+            if (ctrl.WillAcceptTransaction(addr, false)) {
+                ctrl.AddTransaction(dramsim3::Transaction(addr, false));
+                n++;
+            }
+            while (ctrl.ReturnDoneTrans(ctrl.clk_, done) >= 0) {
+                if (done.addr == watch) {
+                    watch_done = ctrl.clk_;
+                }
+            }
+            ctrl.ClockTick();
+        }
+        return watch_done;
+    };
+    auto one_row = [](int n) { return 1; };
+
+    SECTION("Cap grows while conflicts are rare") {
+        config.adaptive_row_hit_cap = true;
+        dramsim3::Controller ctrl(0, config, timing);
+        saturate(ctrl, 5000, one_row, 0);
+        REQUIRE(ctrl.cmd_queue_.row_hit_cap_[0] > config.row_hit_cap);
+        REQUIRE(Counter(ctrl, "row_hit_cap_grows") > 0);
+        REQUIRE(Counter(ctrl, "row_hit_cap_shrinks") == 0);
+    }
+
+    SECTION("Cap shrinks while requests wait") {
+        config.adaptive_row_hit_cap = true;
+        config.row_hit_cap_age_threshold = 100;
+        dramsim3::Controller ctrl(0, config, timing);
+        saturate(ctrl, 5000, [](int n) { return n % 7; }, 0);
+        REQUIRE(ctrl.cmd_queue_.row_hit_cap_[0] == config.row_hit_cap_min);
+        REQUIRE(Counter(ctrl, "row_hit_cap_shrinks") > 0);
+    }
+
+    SECTION("Aged request closes a row with pending hits") {
+        // a read to row 2 behind a stream of row 1 hits, returns the cycle
+        // it finished, 0 if it did not
+        config.row_hit_cap = 64;
+        uint64_t conflict = MakeAddr(config, 0, 0, 2, 0);
+        auto run = [&](int max_age, uint64_t& promotions) {
+            config.max_request_age = max_age;
+            dramsim3::Controller ctrl(0, config, timing);
+            saturate(ctrl, 100, one_row, 0);
+            ctrl.AddTransaction(dramsim3::Transaction(conflict, false));
+            uint64_t done = saturate(ctrl, 2000, one_row, conflict);
+            promotions = Counter(ctrl, "num_aged_promotions");
+            return done;
+        };
+        uint64_t promotions = 0;
+        // back-to-back hits keep the PRE from ever being timing-ready
+        REQUIRE(run(0, promotions) == 0);
+        REQUIRE(promotions == 0);
+        REQUIRE(run(100, promotions) > 0);
+        REQUIRE(promotions > 0);
+    }
+}
+
+TEST_CASE("DUEL followers switch to the best leader policy", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.row_buf_policy = "DUEL";
+    config.duel_policies = {dramsim3::RowBufPolicy::OPEN_PAGE,
+                            dramsim3::RowBufPolicy::SMART_CLOSE};
+    dramsim3::Timing timing(config);
+    dramsim3::Controller ctrl(0, config, timing);
+    auto& cmd_queue = ctrl.cmd_queue_;
+    int leader[2] = {-1, -1};
+    int follower = -1;
+    for (int q = 0; q < cmd_queue.num_queues_; q++) {
+        int c = cmd_queue.duel_leader_of_[q];
+        if (c >= 0 && leader[c] < 0) {
+            leader[c] = q;
+        } else if (c < 0 && follower < 0) {
+            follower = q;
+        }
+    }
+    REQUIRE(leader[0] >= 0);
+    REQUIRE(leader[1] >= 0);
+    REQUIRE(follower >= 0);
+    // one epoch of reads on the leaders of each candidate
+    auto epoch = [&](uint64_t latency_0, uint64_t latency_1) {
+        for (int c = 0; c < 2; c++) {
+            uint64_t latency = c == 0 ? latency_0 : latency_1;
+            if (latency == 0) {
+                continue;
+            }
+            int rank, bankgroup, bank;
+            cmd_queue.GetBankFromIndex(leader[c], rank, bankgroup, bank);
+            for (int i = 0; i < 10; i++) {
+                cmd_queue.OnReadDone(rank, bankgroup, bank, latency);
+            }
+        }
+        cmd_queue.DUEL_ArbitratePolicy();
+    };
+    auto follower_policy = [&]() { return cmd_queue.bank_policy_[follower]; };
+    REQUIRE(cmd_queue.duel_winner_ == 0);
+    REQUIRE(follower_policy() == dramsim3::RowBufPolicy::OPEN_PAGE);
+
+    // within the switch margin the current winner stays
+    epoch(100, 97);
+    REQUIRE(cmd_queue.duel_winner_ == 0);
+    REQUIRE(follower_policy() == dramsim3::RowBufPolicy::OPEN_PAGE);
+
+    epoch(100, 90);
+    REQUIRE(cmd_queue.duel_winner_ == 1);
+    REQUIRE(follower_policy() == dramsim3::RowBufPolicy::SMART_CLOSE);
+    REQUIRE(cmd_queue.bank_policy_[leader[0]] ==
+            dramsim3::RowBufPolicy::OPEN_PAGE);
+    REQUIRE(Counter(ctrl, "duel_switches") == 1);
+
+    // a winner without reads is replaced by any measured candidate
+    epoch(100, 0);
+    REQUIRE(cmd_queue.duel_winner_ == 0);
+    REQUIRE(follower_policy() == dramsim3::RowBufPolicy::OPEN_PAGE);
+    REQUIRE(Counter(ctrl, "duel_switches") == 2);
+}
+
+TEST_CASE("Row hit distances land in doubling buckets", "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.output_level = 0;
+    config.json_stats_name = "test_row_hit_distance.json";
+    dramsim3::Timing timing(config);
+    auto final_stats = [&](dramsim3::Controller& ctrl) {
+        ctrl.PrintFinalStats();
+        std::ifstream j_in(config.json_stats_name);
+        std::string text((std::istreambuf_iterator<char>(j_in)),
+                         std::istreambuf_iterator<char>());
+        j_in.close();
+        std::remove(config.json_stats_name.c_str());
+        return nlohmann::json::parse("{" + text + "}")["0"];
+    };
+    // row 1 is touched again after 5, 20, 100 and 13000 cycles, row 2 once
+    auto run = [&](dramsim3::Controller& ctrl) {
+        int col = 0;
+        ctrl.AddTransaction(dramsim3::Transaction(
+            MakeAddr(config, 0, 0, 2, 0), false));
+        for (int gap : {0, 5, 20, 100, 13000}) {
+            Run(ctrl, gap);
+            ctrl.AddTransaction(dramsim3::Transaction(
+                MakeAddr(config, 0, 0, 1, col++), false));
+        }
+        Run(ctrl, 200);
+    };
+
+    SECTION("Off by default") {
+        dramsim3::Controller ctrl(0, config, timing);
+        REQUIRE_FALSE(ctrl.track_rows_);
+        run(ctrl);
+        auto stats = final_stats(ctrl);
+        REQUIRE(stats["row_hit_distance"].empty());
+    }
+
+    SECTION("Counted per bucket when enabled") {
+        config.row_hit_distance_stats = true;
+        dramsim3::Controller ctrl(0, config, timing);
+        run(ctrl);
+        auto dist = final_stats(ctrl)["row_hit_distance"];
+        // widths 8, 16, 32, ... up to tREFI (12480), then one overflow bucket
+        REQUIRE(dist.size() == 12);
+        std::vector<uint64_t> expected(12, 0);
+        expected[0] = 1;   // 5 in [0-7]
+        expected[1] = 1;   // 20 in [8-23]
+        expected[3] = 1;   // 100 in [56-119]
+        expected[11] = 1;  // 13000 >= tREFI
+        for (int i = 0; i < 12; i++) {
+            REQUIRE(dist[std::to_string(i)].get<uint64_t>() == expected[i]);
+        }
+    }
+}
+
+TEST_CASE("Sampled windows report their mean and 95% interval",
+          "[controller]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.sample_window = 1000;
+    config.output_level = 0;
+    config.json_stats_name = "test_sampled.json";
+    dramsim3::Timing timing(config);
+    dramsim3::Controller ctrl(0, config, timing);
+
+    // window k reads k + 1 rows of bank 0, so the latency grows with k
+    std::vector<double> latencies, bandwidths;
+    dramsim3::Transaction done;
+    for (int k = 0; k < 4; k++) {
+        ctrl.BeginSampleWindow();
+        std::unordered_map<uint64_t, uint64_t> added;
+        for (int i = 0; i <= k; i++) {
+            uint64_t addr = MakeAddr(config, 0, 0, 10 * k + i, 0);
+            ctrl.AddTransaction(dramsim3::Transaction(addr, false));
+            added[addr] = ctrl.clk_;
+        }
+        uint64_t latency = 0;
+        const int cycles = 400;
+        for (int clk = 0; clk < cycles; clk++) {
+            while (ctrl.ReturnDoneTrans(ctrl.clk_, done) >= 0) {
+                latency += ctrl.clk_ - added.at(done.addr);
+            }
+            ctrl.ClockTick();
+        }
+        ctrl.EndSampleWindow();
+        latencies.push_back(static_cast<double>(latency) / (k + 1));
+        bandwidths.push_back((k + 1) * config.request_size_bytes /
+                             (cycles * config.tCK));
+    }
+    // mean and 1.96 standard errors of the window values
+    auto mean_ci = [](const std::vector<double>& vals, double& ci) {
+        double mean = 0.0, var = 0.0;
+        for (auto val : vals) {
+            mean += val / vals.size();
+        }
+        for (auto val : vals) {
+            var += (val - mean) * (val - mean) / (vals.size() - 1);
+        }
+        ci = 1.96 * std::sqrt(var / vals.size());
+        return mean;
+    };
+
+    ctrl.PrintFinalStats();
+    std::ifstream j_in(config.json_stats_name);
+    std::string text((std::istreambuf_iterator<char>(j_in)),
+                     std::istreambuf_iterator<char>());
+    j_in.close();
+    std::remove(config.json_stats_name.c_str());
+    auto stats = nlohmann::json::parse("{" + text + "}")["0"];
+
+    double ci = 0.0;
+    double mean = mean_ci(latencies, ci);
+    REQUIRE(ci > 0.0);
+    REQUIRE(stats["sample_windows"].get<double>() == 4);
+    REQUIRE(stats["sampled_read_latency"].get<double>() == Approx(mean));
+    REQUIRE(stats["sampled_read_latency_ci95"].get<double>() == Approx(ci));
+    mean = mean_ci(bandwidths, ci);
+    REQUIRE(stats["sampled_bandwidth"].get<double>() == Approx(mean));
+    REQUIRE(stats["sampled_bandwidth_ci95"].get<double>() == Approx(ci));
+}
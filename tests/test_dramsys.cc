@@ -1,6 +1,21 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include "catch.hpp"
 #include "configuration.h"
+#include "controller.h"
+#include "cpu.h"
 #include "dram_system.h"
+#include "memory_system.h"
 
 bool call_back_called = false;
 void dummy_call_back(uint64_t addr) {
@@ -30,3 +45,442 @@ TEST_CASE("Jedec DRAMSystem Testing", "[dramsim3]") {
         REQUIRE(clk == tRC);
     }
 }
+
+TEST_CASE("Batched requests complete like single ones", "[dramsim3]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    std::vector<std::pair<uint64_t, int>> single_done;
+    int clk = 0;
+    dramsim3::JedecDRAMSystem single(
+        config, ".", [&](uint64_t addr) { single_done.emplace_back(addr, clk); },
+        [&](uint64_t addr) { single_done.emplace_back(addr, clk); });
+    dramsim3::JedecDRAMSystem batched(config, ".", dummy_call_back,
+                                      dummy_call_back);
+    batched.SetBatchedCompletions(true);
+
+    std::vector<dramsim3::MemRequest> requests;
+    for (uint64_t i = 0; i < 200; i++) {
+        requests.push_back({i * 0x1040, i % 3 == 0, i, i * 7});
+    }
+    std::vector<std::pair<uint64_t, int>> batched_done;
+    std::vector<dramsim3::MemCompletion> done;
+    size_t single_next = 0, batched_next = 0;
+    for (clk = 0; clk < 5000; clk++) {
+        // one request per cycle on the single side, as many as fit batched
+        if (single_next < requests.size() &&
+            single.WillAcceptTransaction(requests[single_next].addr,
+                                         requests[single_next].is_write)) {
+            single.AddTransaction(requests[single_next].addr,
+                                  requests[single_next].is_write);
+            single_next++;
+        }
+        if (batched_next < single_next) {
+            batched_next += batched.AddTransactions(
+                &requests[batched_next], single_next - batched_next);
+        }
+        single.ClockTick();
+        batched.ClockTick();
+        batched.TakeCompletions(done);
+        for (const auto &c : done) {
+            REQUIRE(c.addr == requests[c.id].addr);
+            REQUIRE(c.is_write == requests[c.id].is_write);
+            REQUIRE(c.meta == c.id * 7);
+            batched_done.emplace_back(c.addr, clk);
+        }
+    }
+    REQUIRE(single_done.size() == requests.size());
+    REQUIRE(batched_done == single_done);
+    REQUIRE_FALSE(call_back_called);
+}
+
+TEST_CASE("Same address requests complete with their own ids", "[dramsim3]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    dramsim3::JedecDRAMSystem dramsys(config, ".", dummy_call_back,
+                                      dummy_call_back);
+    std::vector<dramsim3::MemCompletion> done;
+    dramsys.RegisterCompletionCallback(
+        [&](const dramsim3::MemCompletion &c) { done.push_back(c); });
+    dramsim3::MemRequest requests[] = {
+        {0x4000, false, 11, 1}, {0x4000, false, 12, 2}, {0x4000, true, 13, 3}};
+    REQUIRE(dramsys.AddTransactions(requests, 3) == 3);
+    for (int clk = 0; clk < 200; clk++) {
+        dramsys.ClockTick();
+    }
+    REQUIRE(done.size() == 3);
+    std::vector<uint64_t> ids;
+    for (const auto &c : done) {
+        REQUIRE(c.addr == 0x4000);
+        REQUIRE(c.meta == c.id - 10);
+        ids.push_back(c.id);
+    }
+    // the write completes on arrival, the merged reads in arrival order
+    REQUIRE(ids == std::vector<uint64_t>({13, 11, 12}));
+    REQUIRE_FALSE(call_back_called);
+}
+
+TEST_CASE("Batched requests keep to the source bandwidth limit",
+          "[dramsim3]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.num_sources = 2;
+    dramsim3::JedecDRAMSystem dramsys(config, ".", dummy_call_back,
+                                      dummy_call_back);
+    dramsys.SetSourceBandwidth(1, 0.05, 0.0);
+    uint64_t admitted = 0;
+    int refused_by_batch_only = 0;
+    const int cycles = 20000;
+    for (int clk = 0; clk < cycles; clk++) {
+        uint64_t addr = static_cast<uint64_t>(clk) * 0x1040;
+        dramsim3::MemRequest req = {addr, false, 0, 0, 1, 0, 0, false};
+        bool will_accept = dramsys.WillAcceptTransaction(addr, false, 1);
+        size_t added = dramsys.AddTransactions(&req, 1);
+        refused_by_batch_only += added == 0 && will_accept;
+        admitted += added;
+        dramsys.ClockTick();
+    }
+    REQUIRE(refused_by_batch_only == 0);
+    // 5% of the peak, one CAS per burst_cycle, plus the initial burst
+    REQUIRE(admitted > 0);
+    REQUIRE(admitted < cycles * 0.05 / config.burst_cycle * 2);
+}
+
+TEST_CASE("Stale prefetches are reported as dropped", "[dramsim3]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.prefetch_aware = true;
+    config.prefetch_drop_threshold = 20;
+    // demands every cycle keep the prefetches waiting, returns how many
+    // prefetches were reported as dropped and as read
+    auto run = [&](bool drop_callback, size_t& dropped, size_t& read) {
+        std::vector<uint64_t> reads_done, drops;
+        dramsim3::JedecDRAMSystem dramsys(
+            config, ".", [&](uint64_t addr) { reads_done.push_back(addr); },
+            dummy_call_back);
+        if (drop_callback) {
+            dramsys.RegisterPrefetchDropCallback(
+                [&](uint64_t addr) { drops.push_back(addr); });
+        }
+        std::set<uint64_t> prefetches;
+        for (uint64_t clk = 0; clk < 6000; clk++) {
+            uint64_t addr = clk * 0x1040;
+            // never a multiple of 0x1040, so never a demand address
+            uint64_t prefetch = addr + 0x800;
+            if (clk < 4000) {
+                if (dramsys.WillAcceptTransaction(addr, false)) {
+                    dramsys.AddTransaction(addr, false);
+                }
+                if (dramsys.WillAcceptTransaction(prefetch, false) &&
+                    dramsys.AddPrefetch(prefetch, 0)) {
+                    prefetches.insert(prefetch);
+                }
+            }
+            dramsys.ClockTick();
+        }
+        read = std::count_if(
+            reads_done.begin(), reads_done.end(),
+            [&](uint64_t addr) { return prefetches.count(addr) > 0; });
+        dropped = drops.size();
+        // every prefetch is reported once, one way or the other
+        std::set<uint64_t> reported(drops.begin(), drops.end());
+        for (auto addr : reads_done) {
+            if (prefetches.count(addr) > 0) {
+                reported.insert(addr);
+            }
+        }
+        return reported == prefetches && dropped + read == prefetches.size();
+    };
+
+    size_t dropped = 0, read = 0;
+    REQUIRE(run(true, dropped, read));
+    REQUIRE(dropped > 0);
+    REQUIRE(read > 0);
+    // without a drop callback the drops come through the read callback
+    size_t dropped_too = 0, read_all = 0;
+    REQUIRE(run(false, dropped_too, read_all));
+    REQUIRE(dropped_too == 0);
+    REQUIRE(read_all == dropped + read);
+}
+
+TEST_CASE("Stats snapshot tracks the running totals", "[dramsim3]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    dramsim3::JedecDRAMSystem dramsys(config, ".", dummy_call_back,
+                                      dummy_call_back);
+    uint64_t reads_done = 0;
+    dramsys.RegisterCompletionCallback([&](const dramsim3::MemCompletion &c) {
+        reads_done += c.is_write ? 0 : 1;
+    });
+    dramsim3::StatsSnapshot first;
+    for (uint64_t clk = 0; clk < 4000; clk++) {
+        uint64_t addr = clk * 0x1040;
+        if (clk < 2000 && dramsys.WillAcceptTransaction(addr, clk % 3 == 0)) {
+            dramsys.AddTransaction(addr, clk % 3 == 0);
+        }
+        dramsys.ClockTick();
+        if (clk == 1999) {
+            dramsys.GetStatsSnapshot(first);
+        }
+    }
+    dramsim3::StatsSnapshot snap;
+    dramsys.GetStatsSnapshot(snap);
+    REQUIRE(snap.version == dramsim3::STATS_SNAPSHOT_VERSION);
+    REQUIRE(snap.cycle == 4000);
+    REQUIRE(snap.channels.size() == static_cast<size_t>(config.channels));
+    uint64_t snap_reads = 0;
+    for (size_t i = 0; i < snap.channels.size(); i++) {
+        const auto &chan = snap.channels[i];
+        REQUIRE(chan.counters.at("num_cycles") == 4000);
+        REQUIRE(chan.counters.at("num_reads_done") >=
+                first.channels[i].counters.at("num_reads_done"));
+        snap_reads += chan.counters.at("num_reads_done");
+    }
+    REQUIRE(snap_reads == reads_done);
+    REQUIRE(snap.average_read_latency > 0.0);
+    REQUIRE(snap.row_hit_rate >= 0.0);
+    REQUIRE(snap.row_hit_rate <= 1.0);
+    REQUIRE(snap.average_power > 0.0);
+}
+
+TEST_CASE("Side-by-side memory systems keep their own stats",
+          "[dramsim3]") {
+    const char* config_file = "configs/DDR4_8Gb_x8_3200.ini";
+    // a mostly sequential stream for one seed, random lines for the other
+    auto drive = [](dramsim3::MemorySystem& mem, int seed) {
+        std::mt19937_64 gen(seed);
+        uint64_t addr = 0;
+        for (int clk = 0; clk < 20000; clk++) {
+            mem.ClockTick();
+            uint64_t next = seed == 1 ? addr + 64 : gen() & 0xFFFFFFC0;
+            bool is_write = gen() % 4 == 0;
+            if (mem.WillAcceptTransaction(next, is_write)) {
+                mem.AddTransaction(next, is_write);
+                addr = next;
+            }
+        }
+    };
+    struct Result {
+        std::map<std::string, uint64_t> counters;
+        uint64_t row_hits, row_misses;
+    };
+    auto result = [](dramsim3::MemorySystem& mem) {
+        Result res;
+        auto snap = mem.GetStatsSnapshot();
+        for (auto name : {"num_cycles", "num_reads_done", "num_writes_done",
+                          "num_read_row_hits", "num_act_cmds"}) {
+            res.counters[name] = snap.channels[0].counters.at(name);
+        }
+        mem.TakeEpochRowStats(res.row_hits, res.row_misses);
+        return res;
+    };
+    auto ignore = [](uint64_t addr) {};
+
+    // each one alone
+    std::vector<Result> alone;
+    for (int seed : {1, 2}) {
+        dramsim3::MemorySystem mem(config_file, ".", ignore, ignore);
+        drive(mem, seed);
+        alone.push_back(result(mem));
+    }
+    REQUIRE(alone[0].counters != alone[1].counters);
+    REQUIRE(alone[0].row_hits > alone[1].row_hits);
+
+    // both at once on their own threads
+    dramsim3::MemorySystem mem_a(config_file, ".", ignore, ignore);
+    dramsim3::MemorySystem mem_b(config_file, ".", ignore, ignore);
+    std::thread thread_a([&] { drive(mem_a, 1); });
+    std::thread thread_b([&] { drive(mem_b, 2); });
+    thread_a.join();
+    thread_b.join();
+    // mem_b's epoch row counters are read after mem_a's were taken
+    for (auto* mem : {&mem_a, &mem_b}) {
+        auto res = result(*mem);
+        const auto& want = alone[mem == &mem_a ? 0 : 1];
+        REQUIRE(res.counters == want.counters);
+        REQUIRE(res.row_hits == want.row_hits);
+        REQUIRE(res.row_misses == want.row_misses);
+    }
+    // taking them clears them
+    uint64_t row_hits, row_misses;
+    mem_a.TakeEpochRowStats(row_hits, row_misses);
+    REQUIRE(row_hits + row_misses == 0);
+}
+
+TEST_CASE("Warmed GS state matches a detailed run", "[dramsim3]") {
+    dramsim3::Config config("configs/DDR4_8Gb_x8_3200.ini", ".");
+    config.row_buf_policy = "GS";
+    // a refresh would hold back an access in one run but not the other
+    config.tREFI = 1 << 30;
+    dramsim3::Timing timing(config);
+    // reads to bank 0, gaps well clear of the GS timeout values and all
+    // within the first arbitration period
+    const uint64_t gaps[] = {30, 600, 1500};
+    const int rows[] = {1, 1, 2, 1, 3, 3};
+    std::vector<std::pair<uint64_t, uint64_t>> accesses;
+    uint64_t cycle = 0;
+    for (int i = 0; i < 36; i++) {
+        cycle += gaps[i % 3];
+        uint64_t row = rows[i % 6];
+        accesses.push_back(
+            {cycle, row << config.ro_pos << config.shift_bits});
+    }
+    uint64_t end = cycle + 2000;
+
+    // warm up to warm_end, then run in detail with the clock restarting
+    auto run = [&](uint64_t warm_end) {
+        dramsim3::Controller ctrl(0, config, timing);
+        size_t next = 0;
+        while (next < accesses.size() && accesses[next].first < warm_end) {
+            ctrl.WarmTransaction(
+                dramsim3::Transaction(accesses[next].second, false),
+                accesses[next].first);
+            next++;
+        }
+        ctrl.EndWarmup(warm_end);
+        dramsim3::Transaction done;
+        for (uint64_t clk = warm_end; clk < end; clk++) {
+            while (ctrl.ReturnDoneTrans(ctrl.clk_, done) >= 0) {
+            }
+            if (next < accesses.size() && accesses[next].first == clk) {
+                uint64_t addr = accesses[next].second;
+                REQUIRE(ctrl.WillAcceptTransaction(addr, false));
+                ctrl.AddTransaction(dramsim3::Transaction(addr, false));
+                next++;
+            }
+            ctrl.ClockTick();
+        }
+        return ctrl.cmd_queue_.gs_shadow_state_[0];
+    };
+
+    auto detailed = run(0);
+    // the warmed span ends idle before a row change, where the two runs
+    // only differ in an extra precharge
+    auto warmed = run(accesses[20].first - 500);
+    int total = 0;
+    for (int t = 0; t < dramsim3::GS_TIMEOUT_COUNT; t++) {
+        REQUIRE(warmed.hits[t] == detailed.hits[t]);
+        REQUIRE(warmed.conflicts[t] == detailed.conflicts[t]);
+        total += detailed.hits[t] + detailed.conflicts[t];
+    }
+    REQUIRE(total > 0);
+}
+
+TEST_CASE("Sharded replay matches a serial open-loop run", "[dramsim3]") {
+    const char* config_file = "configs/HBM1_4Gb_x128.ini";
+    const char* trace_name = "test_replay.trace";
+    const uint64_t cycles = 3 * dramsim3::REPLAY_CHUNK_CYCLES;
+    {
+        // records a few cycles apart, so the serial run, which takes one
+        // request per cycle for all channels, is never held back either
+        std::ofstream trace(trace_name);
+        std::mt19937_64 gen(7);
+        for (uint64_t clk = 0; clk < cycles; clk += 4) {
+            trace << "0x" << std::hex << (gen() & 0xFFFFFFC0) << std::dec
+                  << (gen() % 3 == 0 ? " WRITE " : " READ ") << clk << "\n";
+        }
+    }
+    auto ignore = [](uint64_t addr) {};
+    dramsim3::MemorySystem serial(config_file, ".", ignore, ignore);
+    dramsim3::MemorySystem sharded(config_file, ".", ignore, ignore);
+
+    std::ifstream trace(trace_name);
+    dramsim3::Transaction trans;
+    bool has_trans = static_cast<bool>(trace >> trans);
+    for (uint64_t clk = 0; clk < cycles; clk++) {
+        serial.ClockTick();
+        if (has_trans && trans.added_cycle <= clk &&
+            serial.WillAcceptTransaction(trans.addr, trans.is_write)) {
+            serial.AddTransaction(trans.addr, trans.is_write);
+            has_trans = static_cast<bool>(trace >> trans);
+        }
+    }
+    sharded.ReplayTrace(trace_name, cycles, 3);
+    std::remove(trace_name);
+
+    auto expected = serial.GetStatsSnapshot();
+    auto actual = sharded.GetStatsSnapshot();
+    REQUIRE(expected.channels.size() == actual.channels.size());
+    REQUIRE(expected.average_read_latency > 0.0);
+    for (size_t i = 0; i < expected.channels.size(); i++) {
+        auto& want = expected.channels[i];
+        auto& got = actual.channels[i];
+        for (auto name : {"num_cycles", "num_reads_done", "num_writes_done",
+                          "num_read_row_hits", "num_act_cmds"}) {
+            REQUIRE(got.counters[name] == want.counters[name]);
+        }
+        REQUIRE(got.average_read_latency == Approx(want.average_read_latency));
+    }
+}
+
+TEST_CASE("Pipelined trace CPU prints the same completions", "[dramsim3]") {
+    // completion lines of the first cycles of the example trace
+    auto run = [](bool pipeline) {
+        std::ostringstream out;
+        auto cout_buf = std::cout.rdbuf();
+        {
+            dramsim3::TraceBasedCPU cpu("configs/DDR4_8Gb_x8_3200.ini", ".",
+                                        "tests/example.trace");
+            std::cout.rdbuf(out.rdbuf());
+            if (pipeline) {
+                cpu.StartPipeline();
+            }
+            for (int clk = 0; clk < 50000; clk++) {
+                cpu.ClockTick();
+            }
+        }
+        std::cout.rdbuf(cout_buf);
+        return out.str();
+    };
+    std::string serial = run(false);
+    REQUIRE(serial.find("Rd complete") != std::string::npos);
+    REQUIRE(run(true) == serial);
+}
+
+TEST_CASE("Restored trace CPU carries on from the saved cycle", "[dramsim3]") {
+    const char* config_file = "configs/DDR4_8Gb_x8_3200.ini";
+    const char* trace_name = "tests/example.trace";
+    const char* file_name = "test_cpu.ckpt";
+    const int save_clk = 20000;
+    // completions after the save point of an uninterrupted run
+    std::ostringstream full_out;
+    auto cout_buf = std::cout.rdbuf();
+    {
+        dramsim3::TraceBasedCPU cpu(config_file, ".", trace_name);
+        std::cout.rdbuf(full_out.rdbuf());
+        for (int clk = 0; clk < 2 * save_clk; clk++) {
+            cpu.ClockTick();
+        }
+    }
+    std::cout.rdbuf(cout_buf);
+    std::string expected;
+    std::istringstream lines(full_out.str());
+    for (std::string line; std::getline(lines, line);) {
+        auto clk = std::stoull(line.substr(line.rfind(' ') + 1));
+        if (clk >= save_clk) {
+            expected += line + "\n";
+        }
+    }
+    REQUIRE(!expected.empty());
+
+    // the helper thread of a pipelined CPU has parsed ahead of the records
+    // the CPU took when it is saved
+    bool pipeline = GENERATE(false, true);
+    std::ostringstream saved_out, restored_out;
+    {
+        dramsim3::TraceBasedCPU cpu(config_file, ".", trace_name);
+        std::cout.rdbuf(saved_out.rdbuf());
+        if (pipeline) {
+            cpu.StartPipeline();
+        }
+        for (int clk = 0; clk < save_clk; clk++) {
+            cpu.ClockTick();
+        }
+        cpu.SaveCheckpoint(file_name);
+    }
+    std::cout.rdbuf(cout_buf);
+    dramsim3::TraceBasedCPU cpu(config_file, ".", trace_name);
+    cpu.RestoreCheckpoint(file_name);
+    std::remove(file_name);
+    REQUIRE(cpu.GetClk() == save_clk);
+    std::cout.rdbuf(restored_out.rdbuf());
+    for (int clk = 0; clk < save_clk; clk++) {
+        cpu.ClockTick();
+    }
+    std::cout.rdbuf(cout_buf);
+    REQUIRE(restored_out.str() == expected);
+}
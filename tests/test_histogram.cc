@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "catch.hpp"
+#include "histogram.h"
+
+TEST_CASE("Log-linear histogram", "[histogram]") {
+    dramsim3::LogLinearHistogram histo;
+
+    SECTION("Small values are exact") {
+        for (uint64_t i = 0; i < 100; i++) {
+            histo.Record(i);
+        }
+        REQUIRE(histo.Count() == 100);
+        REQUIRE(histo.Mean() == Approx(49.5));
+        REQUIRE(histo.Percentile(0.5) == 49);
+        REQUIRE(histo.Percentile(0.99) == 98);
+        REQUIRE(histo.Percentile(1.0) == 99);
+    }
+
+    SECTION("Tail percentiles stay within the bucket error") {
+        // a long tailed latency distribution
+        std::mt19937_64 gen(1);
+        std::exponential_distribution<double> dist(1.0 / 300);
+        std::vector<uint64_t> values;
+        for (int i = 0; i < 100000; i++) {
+            values.push_back(20 + static_cast<uint64_t>(dist(gen)));
+            histo.Record(values.back());
+        }
+        std::sort(values.begin(), values.end());
+        for (double q : {0.5, 0.99, 0.999, 0.9999}) {
+            auto exact = values[static_cast<size_t>(
+                std::ceil(q * values.size())) - 1];
+            REQUIRE(histo.Percentile(q) >= exact);
+            REQUIRE(histo.Percentile(q) <= exact + exact / 64);
+        }
+        REQUIRE(histo.Percentile(1.0) == values.back());
+        REQUIRE(histo.Max() == values.back());
+    }
+
+    SECTION("Merged histograms equal one recording everything") {
+        dramsim3::LogLinearHistogram a, b;
+        for (uint64_t i = 0; i < 5000; i++) {
+            uint64_t val = (i * 7919) % 100000;
+            (i % 2 ? a : b).Record(val);
+            histo.Record(val);
+        }
+        a.Merge(b);
+        REQUIRE(a.Count() == histo.Count());
+        REQUIRE(a.Mean() == Approx(histo.Mean()));
+        for (double q : {0.5, 0.99, 0.999}) {
+            REQUIRE(a.Percentile(q) == histo.Percentile(q));
+        }
+    }
+}
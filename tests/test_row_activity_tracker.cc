@@ -0,0 +1,32 @@
+#include "catch.hpp"
+#include "row_activity_tracker.h"
+
+TEST_CASE("Row activity tracker", "[tracker]") {
+    dramsim3::RowActivityTracker tracker(16);
+
+    SECTION("Last touch of recorded rows") {
+        uint64_t clk = 0;
+        REQUIRE_FALSE(tracker.LastTouch(3, 100, clk));
+        tracker.Touch(3, 100, 10);
+        tracker.Touch(3, 100, 25);
+        REQUIRE(tracker.LastTouch(3, 100, clk));
+        REQUIRE(clk == 25);
+        // same row in another bank is a different row
+        REQUIRE_FALSE(tracker.LastTouch(4, 100, clk));
+    }
+
+    SECTION("Hotness never under counts and decays") {
+        for (int i = 0; i < 50; i++) {
+            tracker.Touch(0, 7, i);
+        }
+        tracker.Touch(0, 8, 50);
+        REQUIRE(tracker.Hotness(0, 7) >= 50);
+        REQUIRE(tracker.Hotness(0, 8) >= 1);
+        REQUIRE(tracker.Hotness(0, 8) < tracker.Hotness(0, 7));
+        // enough other touches to trigger a decay
+        for (uint64_t i = 0; i < dramsim3::ROW_TRACKER_DECAY_TOUCHES; i++) {
+            tracker.Touch(1, static_cast<int>(i % 4096), 100 + i);
+        }
+        REQUIRE(tracker.Hotness(0, 7) < 50);
+    }
+}